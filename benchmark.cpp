@@ -0,0 +1,376 @@
+/***             GRAU B - Editor de Pista de Corrida              ***/
+/*** Computação Gráfica em Tempo Real - Jogos Digitais - Unisinos ***/
+/***        Benchmarks: caminhos otimizados contra os originais       ***/
+
+/*** Mede cada caminho otimizado contra uma cópia da implementação que ele substituiu,
+     mantida aqui só como referência, e confere que os dois dão o mesmo resultado.
+     Cada medida é a mediana de -r repetições.
+
+     Uso: track_benchmark <caso> [-n tamanho] [-r repeticoes]
+        bases  - funções de base: Cox-de Boor recursivo (baseBSpline original) contra o
+                 triangular iterativo (calcularBasesNaoNulas / CurvaNURBS::avaliarLote),
+                 graus 2 a 7; -n = amostras por grau (padrão 200000)
+        obj    - exportarOBJ (EscritorTexto, seções em paralelo) contra a escrita original
+                 linha a linha com operator<< e endl; os dois arquivos precisam ser
+                 idênticos byte a byte; -n = amostras da pista (padrão 200000)
+        threads - exportarOBJ da mesma pista com o pool global em 1, 2, 4 e 8 threads; as
+                  saídas precisam ser idênticas byte a byte entre as contagens;
+                  -n = amostras da pista (padrão 1000000)
+***/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <glm/glm.hpp>
+
+#include "NURBS.h"
+#include "TrackEditor.h"
+#include "ThreadPool.h"
+
+using namespace std;
+using namespace glm;
+using namespace std::chrono;
+
+// Opções da linha de comando
+struct OpcoesBenchmark {
+    string caso;
+    int tamanho = 0;        // 0 = padrão do caso
+    int repeticoes = 5;
+};
+
+static bool lerOpcoes(int argc, char** argv, OpcoesBenchmark& opcoes);
+static double medirMediana(int repeticoes, const function<void()>& executar);
+static bool benchmarkBases(const OpcoesBenchmark& opcoes);
+static bool benchmarkOBJ(const OpcoesBenchmark& opcoes);
+static bool benchmarkThreads(const OpcoesBenchmark& opcoes);
+
+// Evita que o compilador descarte os resultados medidos
+static volatile float sumidouro;
+
+int main(int argc, char** argv) {
+    OpcoesBenchmark opcoes;
+    if (!lerOpcoes(argc, argv, opcoes)) return EXIT_FAILURE;
+
+    bool ok = false;
+    if (opcoes.caso == "bases") ok = benchmarkBases(opcoes);
+    else if (opcoes.caso == "obj") ok = benchmarkOBJ(opcoes);
+    else if (opcoes.caso == "threads") ok = benchmarkThreads(opcoes);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// Tempo mediano (ms) de 'repeticoes' execuções
+static double medirMediana(int repeticoes, const function<void()>& executar) {
+    vector<double> tempos;
+    for (int r = 0; r < repeticoes; r++) {
+        auto inicio = steady_clock::now();
+        executar();
+        tempos.push_back(duration<double, milli>(steady_clock::now() - inicio).count());
+    }
+    nth_element(tempos.begin(), tempos.begin() + tempos.size() / 2, tempos.end());
+    return tempos[tempos.size() / 2];
+}
+
+
+// ---------------------------------------------------------------------------------------
+// bases
+
+// baseBSpline original do editor: Cox-de Boor recursivo com nós uniformes inteiros
+// (custo exponencial no grau)
+static float baseRecursiva(int i, int k, float t) {
+    if (k == 0) {
+        return (t >= i && t < i + 1) ? 1.0f : 0.0f;
+    }
+    float c1 = (t - i) / k;
+    float c2 = (i + k + 1 - t) / k;
+    return c1 * baseRecursiva(i, k - 1, t) + c2 * baseRecursiva(i + 1, k - 1, t);
+}
+
+static bool benchmarkBases(const OpcoesBenchmark& opcoes) {
+    const int amostras = opcoes.tamanho > 0 ? opcoes.tamanho : 200000;
+    bool ok = true;
+
+    cout << "Funcoes de base (" << amostras << " parametros por grau, ns por parametro, as grau+1 bases)" << endl;
+    cout << "grau  recursivo  iterativo  aceleracao  erro maximo" << endl;
+    for (int grau = 2; grau <= NURBS_GRAU_MAXIMO; grau++) {
+        // Nós uniformes 0..2*grau+1: no intervalo [grau, grau+1) as bases não nulas são N(0..grau)
+        vector<float> nos(2 * grau + 2);
+        for (size_t i = 0; i < nos.size(); i++) nos[i] = float(i);
+        vector<float> parametros(amostras);
+        for (int s = 0; s < amostras; s++) parametros[s] = grau + (s + 0.5f) / amostras;
+
+        float erro = 0.0f;
+        for (int s = 0; s < amostras; s += 97) {
+            float N[NURBS_GRAU_MAXIMO + 1];
+            calcularBasesNaoNulas(grau, parametros[s], grau, nos.data(), N);
+            for (int j = 0; j <= grau; j++) erro = std::max(erro, std::abs(N[j] - baseRecursiva(j, grau, parametros[s])));
+        }
+
+        double recursivo = medirMediana(opcoes.repeticoes, [&]() {
+            float soma = 0.0f;
+            for (float t : parametros) {
+                for (int j = 0; j <= grau; j++) soma += baseRecursiva(j, grau, t);
+            }
+            sumidouro = soma;
+        });
+        double iterativo = medirMediana(opcoes.repeticoes, [&]() {
+            float soma = 0.0f;
+            float N[NURBS_GRAU_MAXIMO + 1];
+            for (float t : parametros) {
+                calcularBasesNaoNulas(grau, t, grau, nos.data(), N);
+                for (int j = 0; j <= grau; j++) soma += N[j];
+            }
+            sumidouro = soma;
+        });
+
+        char linha[128];
+        snprintf(linha, sizeof(linha), "%4d  %9.1f  %9.1f  %9.1fx  %.2e",
+                 grau, recursivo * 1e6 / amostras, iterativo * 1e6 / amostras, recursivo / iterativo, erro);
+        cout << linha << endl;
+        ok = ok && erro < 1e-5f;
+    }
+
+    // Curva fechada inteira: soma ponderada dos pontos com as bases recursivas contra avaliarLote
+    vector<vec2> pontos;
+    for (int i = 0; i < 1000; i++) {
+        float t = 6.2831853f * i / 1000;
+        pontos.push_back(vec2(3.5f * cos(t) * (1.0f + 0.15f * sin(5.0f * t)), 3.0f * sin(t)));
+    }
+    const int porSegmento = std::max(1, amostras / int(pontos.size()));
+    cout << endl << "Curva fechada de " << pontos.size() << " pontos, " << porSegmento
+         << " amostras por segmento (milhoes de amostras por segundo)" << endl;
+    cout << "grau  recursivo  avaliarLote  aceleracao  erro maximo" << endl;
+    for (int grau = 2; grau <= NURBS_GRAU_MAXIMO; grau++) {
+        CurvaNURBS curva = CurvaNURBS::fechadaUniforme(pontos, grau);
+        vector<float> parametros;
+        for (int s = 0; s < (int)pontos.size(); s++) {
+            for (int j = 0; j < porSegmento; j++) parametros.push_back(grau + s + float(j) / porSegmento);
+        }
+        vector<vec2> referencia(parametros.size()), saida(parametros.size());
+
+        double recursivo = medirMediana(opcoes.repeticoes, [&]() {
+            for (size_t a = 0; a < parametros.size(); a++) {
+                float t = parametros[a];
+                int intervalo = int(t);
+                vec2 p(0.0f);
+                for (int j = intervalo - grau; j <= intervalo; j++) p += baseRecursiva(j, grau, t) * curva.pontos[j];
+                referencia[a] = p;
+            }
+        });
+        double lote = medirMediana(opcoes.repeticoes, [&]() {
+            curva.avaliarLote(parametros.data(), parametros.size(), saida.data());
+        });
+
+        float erro = 0.0f;
+        for (size_t a = 0; a < saida.size(); a++) erro = std::max(erro, length(saida[a] - referencia[a]));
+
+        char linha[128];
+        snprintf(linha, sizeof(linha), "%4d  %9.2f  %11.2f  %9.1fx  %.2e", grau,
+                 parametros.size() / (recursivo * 1e3), parametros.size() / (lote * 1e3), recursivo / lote, erro);
+        cout << linha << endl;
+        ok = ok && erro < 1e-4f;
+    }
+
+    if (!ok) cout << "Diferenca acima da tolerancia entre as implementacoes" << endl;
+    return ok;
+}
+
+
+// ---------------------------------------------------------------------------------------
+// obj
+
+// Descarta o que o TrackEditor escreve no cout enquanto existe (mensagens de cada etapa)
+struct SilenciarCout {
+    ostringstream descarte;
+    streambuf* anterior;
+    SilenciarCout() : anterior(cout.rdbuf(descarte.rdbuf())) {}
+    ~SilenciarCout() { cout.rdbuf(anterior); }
+};
+
+// Pista em "8" (com cruzamento e pontes) com cerca de 'amostras' amostras: malha
+// triangularizada e com normais, pronta para exportar
+static void gerarPistaDeTeste(TrackEditor& editor, int amostras) {
+    const int porSegmento = 50;
+    int numPontos = std::max(8, amostras / porSegmento);
+    vector<vec2> pontos;
+    for (int i = 0; i < numPontos; i++) {
+        float t = 6.2831853f * i / numPontos;
+        pontos.push_back(vec2(4.0f * sin(t), 2.5f * sin(2.0f * t)));
+    }
+
+    SilenciarCout silencio;
+    editor.definirPontosDeControle(pontos);
+    editor.definirPontes(true, 0.3f, 1.0f);
+    editor.gerarBSpline(porSegmento);
+    editor.calcularCurvasInternaExterna(0.3f);
+    editor.triangularizarMalha();
+    editor.calcularNormais();
+}
+
+// exportarOBJ original: uma linha por vez com operator<< e endl (descarrega a cada linha)
+static bool exportarOBJOriginal(const vector<Vertex>& vertices, const vector<Triangle>& triangles,
+                                const string& filenameObj, const string& filenameMtl) {
+    ofstream file(filenameObj);
+    if (!file.is_open()) return false;
+
+    file << "# Editor de Pista de Corrida" << endl;
+    file << "# Quantidade de Vertices: " << vertices.size() << endl;
+    file << "# Quantidade de Faces/Triangulos: " << triangles.size() << endl;
+    file << endl;
+
+    file << "mtllib " << filenameMtl << endl;
+    file << "usemtl track_material" << endl;
+    file << endl;
+
+    for (const auto& v : vertices) {
+        file << "v " << v.position.x << " " << v.position.z << " " << v.position.y << endl;
+    }
+    file << endl;
+
+    for (const auto& v : vertices) {
+        file << "vt " << v.texCoord.x << " " << v.texCoord.y << endl;
+    }
+    file << endl;
+
+    for (const auto& v : vertices) {
+        file << "vn " << v.normal.x << " " << v.normal.z << " " << v.normal.y << endl;
+    }
+    file << endl;
+
+    for (const auto& tri : triangles) {
+        file << "f "
+             << (tri.v1 + 1) << "/" << (tri.v1 + 1) << "/" << (tri.v1 + 1) << " "
+             << (tri.v2 + 1) << "/" << (tri.v2 + 1) << "/" << (tri.v2 + 1) << " "
+             << (tri.v3 + 1) << "/" << (tri.v3 + 1) << "/" << (tri.v3 + 1) << endl;
+    }
+    return true;
+}
+
+// Conteúdo inteiro de um arquivo (vazio se não abrir)
+static string lerArquivo(const string& filename) {
+    ifstream file(filename, ios::binary);
+    ostringstream conteudo;
+    conteudo << file.rdbuf();
+    return conteudo.str();
+}
+
+static bool benchmarkOBJ(const OpcoesBenchmark& opcoes) {
+    const int amostras = opcoes.tamanho > 0 ? opcoes.tamanho : 200000;
+    TrackEditor editor;
+    gerarPistaDeTeste(editor, amostras);
+    const vector<Vertex>& vertices = editor.obterVertices();
+    const vector<Triangle>& triangles = editor.obterTriangulos();
+
+    // exportarOBJ grava <prefixo>track.obj e <prefixo>track.mtl; a referência usa o mesmo
+    // mtllib, então os dois arquivos têm que ser iguais
+    const string prefixo = "benchmark_";
+    const string arquivoOriginal = prefixo + "original.obj";
+
+    double original = medirMediana(opcoes.repeticoes, [&]() {
+        exportarOBJOriginal(vertices, triangles, arquivoOriginal, prefixo + "track.mtl");
+    });
+    double atual = medirMediana(opcoes.repeticoes, [&]() {
+        SilenciarCout silencio;
+        TrackEditor::exportarOBJ(vertices, triangles, prefixo);
+    });
+
+    string referencia = lerArquivo(arquivoOriginal);
+    bool iguais = !referencia.empty() && referencia == lerArquivo(prefixo + "track.obj");
+    double megabytes = referencia.size() / 1e6;
+
+    cout << "OBJ de " << vertices.size() << " vertices e " << triangles.size() << " triangulos, "
+         << megabytes << " MB (" << ThreadPool::global().obterNumeroDeThreads() << " threads)" << endl;
+    char linha[128];
+    snprintf(linha, sizeof(linha), "original     %9.1f ms  %7.1f MB/s", original, megabytes / (original / 1e3));
+    cout << linha << endl;
+    snprintf(linha, sizeof(linha), "exportarOBJ  %9.1f ms  %7.1f MB/s  %.1fx", atual, megabytes / (atual / 1e3), original / atual);
+    cout << linha << endl;
+    if (!iguais) cout << "Arquivos diferentes entre as implementacoes" << endl;
+
+    for (const string& arquivo : { arquivoOriginal, prefixo + "track.obj", prefixo + "track.mtl" }) {
+        remove(arquivo.c_str());
+    }
+    return iguais;
+}
+
+
+// ---------------------------------------------------------------------------------------
+// threads
+
+static bool benchmarkThreads(const OpcoesBenchmark& opcoes) {
+    const int amostras = opcoes.tamanho > 0 ? opcoes.tamanho : 1000000;
+    TrackEditor editor;
+    gerarPistaDeTeste(editor, amostras);
+    const vector<Vertex>& vertices = editor.obterVertices();
+    const vector<Triangle>& triangles = editor.obterTriangulos();
+
+    const string prefixo = "benchmark_";
+    ThreadPool& pool = ThreadPool::global();
+    const int threadsOriginais = pool.obterNumeroDeThreads();
+
+    cout << "exportarOBJ de " << vertices.size() << " vertices e " << triangles.size() << " triangulos" << endl;
+    cout << "threads         ms     MB/s  aceleracao" << endl;
+    string referencia;
+    double tempoUmaThread = 0.0;
+    bool iguais = true;
+    for (int threads : { 1, 2, 4, 8 }) {
+        pool.redimensionar(threads);
+        double tempo = medirMediana(opcoes.repeticoes, [&]() {
+            SilenciarCout silencio;
+            TrackEditor::exportarOBJ(vertices, triangles, prefixo);
+        });
+
+        // A divisão em seções não pode mudar o arquivo: compara com a saída de 1 thread
+        string conteudo = lerArquivo(prefixo + "track.obj");
+        if (threads == 1) {
+            referencia = conteudo;
+            tempoUmaThread = tempo;
+        }
+        bool igual = !conteudo.empty() && conteudo == referencia;
+        iguais = iguais && igual;
+
+        char linha[128];
+        snprintf(linha, sizeof(linha), "%7d  %9.1f  %7.1f  %9.2fx%s", threads, tempo,
+                 conteudo.size() / 1e6 / (tempo / 1e3), tempoUmaThread / tempo, igual ? "" : "  (diferente)");
+        cout << linha << endl;
+    }
+    pool.redimensionar(threadsOriginais);
+    if (!iguais) cout << "Saida diferente entre as contagens de threads" << endl;
+
+    for (const string& arquivo : { prefixo + "track.obj", prefixo + "track.mtl" }) {
+        remove(arquivo.c_str());
+    }
+    return iguais;
+}
+
+
+static bool lerOpcoes(int argc, char** argv, OpcoesBenchmark& opcoes) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool temValor = i + 1 < argc;
+        if (arg == "-n" && temValor) {
+            opcoes.tamanho = atoi(argv[++i]);
+        } else if (arg == "-r" && temValor) {
+            opcoes.repeticoes = atoi(argv[++i]);
+        } else if (arg[0] != '-' && opcoes.caso.empty()) {
+            opcoes.caso = arg;
+        } else {
+            opcoes.caso.clear();    // Opção desconhecida: mostra o uso
+            break;
+        }
+    }
+    bool casoValido = opcoes.caso == "bases" || opcoes.caso == "obj" || opcoes.caso == "threads";
+    if (!casoValido || opcoes.tamanho < 0 || opcoes.repeticoes < 1) {
+        cerr << "Uso: " << argv[0] << " <bases|obj|threads> [-n tamanho] [-r repeticoes]" << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,406 @@
+/***             GRAU B - Editor de Pista de Corrida              ***/
+/*** Computação Gráfica em Tempo Real - Jogos Digitais - Unisinos ***/
+/***          Modo headless: snapshots e medição do desenho          ***/
+
+/*** Desenha um projeto do editor sem janela e sem GPU (EGL surfaceless, ex.: Mesa
+     llvmpipe), com o mesmo RenderizadorEditor do editor, em três cenários:
+        parado     - o mesmo quadro redesenhado (nada a enviar)
+        vista      - zoom contínuo em direção a um trecho da pista (índices refeitos a cada quadro)
+        arraste    - um ponto de controle arrastado em círculo (regeneração incremental)
+     e, com as curvas avaliadas na GPU, em um quarto:
+        parametros - resolução e largura diferentes a cada quadro (só uniforms, nada recalculado)
+     Para cada cenário grava um PNG do último quadro e informa os tempos de CPU (chamada de
+     desenho), de GPU (GL_TIME_ELAPSED) e total até a GPU terminar (glFinish) por quadro; no
+     llvmpipe a rasterização só acontece no glFinish, então lá o total é a medida que conta.
+     Com -c, grava as medidas de cada quadro em CSV, para comparar execuções na integração
+     contínua.
+
+     Antes e depois dos cenários, as amostras que o shader de avaliação na GPU calcula são
+     comparadas com as do TrackEditor (paridade CPU/GPU); diferença acima da tolerância faz
+     o programa terminar com erro.
+
+     Uso: track_headless [projeto.proj] [-o prefixo] [-n quadros] [-l largura] [-a altura]
+                         [-s pontos] [-c tempos.csv] [-g] [-t rastreamento.json]
+        -s gera uma pista sintética com esse número de pontos de controle em vez de ler o projeto
+        -g desenha as curvas avaliadas na GPU (tecla U do editor; também quando o projeto a tem ligada)
+        -t grava as etapas da geração e de cada quadro em JSON trace_event (chrome://tracing, Perfetto)
+***/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cfloat>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "TrackEditor.h"
+#include "RenderizadorEditor.h"
+#include "CameraEditor.h"
+#include "ContextoOffscreen.h"
+#include "EscritorPNG.h"
+#include "ProjetoPista.h"
+#include "Perfilador.h"
+
+using namespace std;
+using namespace glm;
+using namespace std::chrono;
+
+// Medidas de um quadro
+struct AmostraQuadro {
+    double preparo;     // Edição/vista antes do quadro (ms de CPU)
+    double cpu;         // glClear + desenhar (ms de CPU, sem esperar a GPU)
+    double gpu;         // Tempo da GPU para o quadro (ms)
+    double total;       // Do início do desenho até a GPU terminar (ms)
+    size_t bytes;       // Bytes enviados à GPU
+    size_t indices;     // Índices das curvas desenhados
+};
+
+// Opções da linha de comando
+struct OpcoesHeadless {
+    string projeto = "track.proj";
+    string prefixo = "snapshot";
+    string csv;
+    string rastreamento;
+    int quadros = 120;
+    int largura = 1024;
+    int altura = 768;
+    int pontosSinteticos = 0;
+    bool curvasNaGPU = false;
+};
+
+static bool lerOpcoes(int argc, char** argv, OpcoesHeadless& opcoes);
+static void gerarPistaSintetica(int numPontos, vector<vec2>& pontos);
+static void enquadrar(const TrackEditor& editor, CameraEditor& camera);
+static double percentil(vector<double> valores, double p);
+static bool verificarParidade(RenderizadorEditor& renderizador, const TrackEditor& editor, float largura);
+static bool executarCenario(const string& nome, const OpcoesHeadless& opcoes, ContextoOffscreen& contexto,
+                            RenderizadorEditor& renderizador, const TrackEditor& editor,
+                            const function<void(int)>& preparar, ofstream& csv);
+
+int main(int argc, char** argv) {
+    OpcoesHeadless opcoes;
+    if (!lerOpcoes(argc, argv, opcoes)) return EXIT_FAILURE;
+    Perfilador::nomearThread("principal");
+    Perfilador::ativar(!opcoes.rastreamento.empty());
+
+    // Pontos de controle e parâmetros: do projeto (só leitura) ou sintéticos
+    vector<vec2> pontos;
+    ParametrosProjeto parametros;
+    if (opcoes.pontosSinteticos > 0) {
+        gerarPistaSintetica(opcoes.pontosSinteticos, pontos);
+    } else {
+        ProjetoPista projeto(opcoes.projeto);
+        if (!projeto.ler(pontos, parametros)) {
+            cerr << "Projeto nao encontrado ou invalido: " << opcoes.projeto << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (pontos.size() < 4) {
+        cerr << "O projeto precisa de pelo menos 4 pontos de controle (tem " << pontos.size() << ")" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Curva e bordas como as teclas G e T do editor
+    TrackEditor editor;
+    editor.definirPontosDeControle(pontos);
+    editor.definirPontes(parametros.pontesAutomaticas, parametros.alturaPonte, parametros.comprimentoRampa);
+    if (parametros.tesselacaoAdaptativa) {
+        editor.gerarBSplineAdaptativa(parametros.toleranciaCorda, parametros.toleranciaAngulo);
+    } else {
+        editor.gerarBSplineDeGrau(parametros.grauCurva, parametros.pontosPorSegmento);
+    }
+    editor.calcularCurvasInternaExterna(parametros.larguraDaPista);
+
+    ContextoOffscreen contexto;
+    if (!contexto.criar(opcoes.largura, opcoes.altura)) return EXIT_FAILURE;
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);     // Mesma cor de fundo do editor
+
+    RenderizadorEditor renderizador;
+    if (!renderizador.inicializar(opcoes.largura, opcoes.altura)) return EXIT_FAILURE;
+    renderizador.definirAvaliacaoNaGPU(opcoes.curvasNaGPU || parametros.avaliacaoNaGPU);
+    renderizador.definirParametrosGPU(parametros.pontosPorSegmento, parametros.larguraDaPista);
+
+    CameraEditor camera;
+    camera.definirJanela(opcoes.largura, opcoes.altura);
+    enquadrar(editor, camera);
+    renderizador.definirCamera(camera);
+
+    ofstream csv;
+    if (!opcoes.csv.empty()) {
+        csv.open(opcoes.csv, ios::trunc);
+        if (!csv.is_open()) {
+            cerr << "Erro ao abrir arquivo: " << opcoes.csv << endl;
+            return EXIT_FAILURE;
+        }
+        csv << "cenario,quadro,preparo_ms,cpu_ms,gpu_ms,total_ms,bytes,indices\n";
+    }
+
+    cout << "Renderizador: " << contexto.obterRenderizador() << endl;
+    cout << opcoes.largura << "x" << opcoes.altura << ", " << pontos.size() << " pontos de controle, "
+         << editor.obterPontosBSpline().size() << " amostras por curva, " << opcoes.quadros << " quadros por cenario" << endl;
+
+    // Primeiro quadro fora das medidas: envio inicial de tudo e compilação do shader pelo driver
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderizador.desenhar(editor);
+    glFinish();
+
+    bool ok = verificarParidade(renderizador, editor, parametros.larguraDaPista);
+    ok = executarCenario("parado", opcoes, contexto, renderizador, editor, [](int) {}, csv) && ok;
+
+    // Zoom de até 50x em direção a uma amostra da curva, um passo por quadro
+    const vec2 alvo = editor.obterPontosBSpline()[editor.obterPontosBSpline().size() / 3];
+    ok = executarCenario("vista", opcoes, contexto, renderizador, editor, [&](int quadro) {
+        CameraEditor vista = camera;
+        vista.aplicarZoom(pow(50.0f, float(quadro + 1) / opcoes.quadros), alvo);
+        renderizador.definirCamera(vista);
+    }, csv) && ok;
+
+    // Ponto de controle arrastado em círculo com a pista inteira na vista; com as curvas na
+    // GPU o editor só regenera as amostras ao soltar o ponto, como no editor
+    renderizador.definirCamera(camera);
+    const int indiceArrastado = int(pontos.size() / 4);
+    const vec2 origem = pontos[indiceArrastado];
+    const float raio = 0.5f * length(pontos[indiceArrastado + 1] - origem);   // Sem dobrar a pista sobre si
+    ok = executarCenario("arraste", opcoes, contexto, renderizador, editor, [&](int quadro) {
+        float angulo = 6.2831853f * float(quadro + 1) / opcoes.quadros;
+        editor.moverPontoDeControle(indiceArrastado, origem + raio * vec2(sin(angulo), 1.0f - cos(angulo)));
+        if (!renderizador.curvasNaGPU(editor)) editor.atualizarTrechosAlterados();
+    }, csv) && ok;
+    editor.concluirEdicao();
+    ok = verificarParidade(renderizador, editor, parametros.larguraDaPista) && ok;
+
+    // Resolução de 1/4 a 2x a do projeto e largura de 1/2 a 3/2, mudando a cada quadro: com
+    // as curvas na GPU são só uniforms, sem amostras recalculadas nem enviadas
+    if (renderizador.curvasNaGPU(editor)) {
+        ok = executarCenario("parametros", opcoes, contexto, renderizador, editor, [&](int quadro) {
+            float fase = 0.5f - 0.5f * cos(6.2831853f * float(quadro + 1) / opcoes.quadros);
+            int resolucao = std::max(1, int(parametros.pontosPorSegmento * (0.25f + 1.75f * fase)));
+            renderizador.definirParametrosGPU(resolucao, parametros.larguraDaPista * (0.5f + fase));
+        }, csv) && ok;
+        renderizador.definirParametrosGPU(parametros.pontosPorSegmento, parametros.larguraDaPista);
+    }
+
+    GLenum erro = glGetError();
+    if (erro != GL_NO_ERROR) {
+        cerr << "Erro OpenGL: 0x" << hex << erro << dec << endl;
+        ok = false;
+    }
+
+    renderizador.finalizar();
+    contexto.destruir();
+    if (!opcoes.rastreamento.empty()) {
+        Perfilador::ativar(false);
+        ok = Perfilador::gravarRastreamento(opcoes.rastreamento) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// Desenha 'quadros' quadros chamando preparar(i) antes de cada um, mostra o resumo dos
+// tempos e grava o último quadro em <prefixo>_<nome>.png
+static bool executarCenario(const string& nome, const OpcoesHeadless& opcoes, ContextoOffscreen& contexto,
+                            RenderizadorEditor& renderizador, const TrackEditor& editor,
+                            const function<void(int)>& preparar, ofstream& csv) {
+    GLuint consulta;
+    glGenQueries(1, &consulta);
+
+    vector<AmostraQuadro> amostras;
+    amostras.reserve(opcoes.quadros);
+    for (int i = 0; i < opcoes.quadros; i++) {
+        PERFIL_ZONA("quadro");
+        AmostraQuadro a;
+        auto inicio = steady_clock::now();
+        preparar(i);
+        auto inicioDesenho = steady_clock::now();
+
+        glBeginQuery(GL_TIME_ELAPSED, consulta);
+        glClear(GL_COLOR_BUFFER_BIT);
+        renderizador.desenhar(editor);
+        glEndQuery(GL_TIME_ELAPSED);
+        auto fimDesenho = steady_clock::now();
+
+        // Como a troca de buffers da janela: o próximo quadro só começa com este pronto
+        {
+            PERFIL_ZONA("glFinish");
+            glFinish();
+        }
+        auto fimQuadro = steady_clock::now();
+        GLuint64 nanossegundos = 0;
+        glGetQueryObjectui64v(consulta, GL_QUERY_RESULT, &nanossegundos);
+
+        a.preparo = duration<double, milli>(inicioDesenho - inicio).count();
+        a.cpu = duration<double, milli>(fimDesenho - inicioDesenho).count();
+        a.gpu = nanossegundos * 1e-6;
+        a.total = duration<double, milli>(fimQuadro - inicioDesenho).count();
+        a.bytes = renderizador.obterBytesEnviados();
+        a.indices = renderizador.obterIndicesDesenhados();
+        amostras.push_back(a);
+
+        if (csv.is_open()) {
+            csv << nome << "," << i << "," << a.preparo << "," << a.cpu << "," << a.gpu << "," << a.total << ","
+                << a.bytes << "," << a.indices << "\n";
+        }
+    }
+    glDeleteQueries(1, &consulta);
+
+    // Resumo: mediana, percentil 95 e máximo
+    vector<double> preparo, cpu, gpu, total, bytes;
+    for (const AmostraQuadro& a : amostras) {
+        preparo.push_back(a.preparo);
+        cpu.push_back(a.cpu);
+        gpu.push_back(a.gpu);
+        total.push_back(a.total);
+        bytes.push_back(double(a.bytes));
+    }
+    auto resumo = [](const vector<double>& v) {
+        char texto[96];
+        snprintf(texto, sizeof(texto), "mediana %.3f  p95 %.3f  max %.3f",
+                 percentil(v, 0.5), percentil(v, 0.95), percentil(v, 1.0));
+        return string(texto);
+    };
+    cout << endl << "[" << nome << "]" << endl;
+    cout << "  CPU (ms):     " << resumo(cpu) << endl;
+    cout << "  GPU (ms):     " << resumo(gpu) << endl;
+    cout << "  total (ms):   " << resumo(total) << endl;
+    if (percentil(preparo, 1.0) >= 0.001) cout << "  preparo (ms): " << resumo(preparo) << endl;
+    cout << "  bytes enviados por quadro (mediana): " << size_t(percentil(bytes, 0.5))
+         << ", indices no ultimo quadro: " << amostras.back().indices << endl;
+
+    vector<uint8_t> rgba;
+    contexto.lerPixels(rgba);
+    string caminho = opcoes.prefixo + "_" + nome + ".png";
+    if (!gravarPNG(caminho, opcoes.largura, opcoes.altura, rgba)) return false;
+    cout << "  snapshot: " << caminho << endl;
+    return true;
+}
+
+
+// Maior distância entre as amostras do shader e as do TrackEditor, em unidades de mundo e
+// em múltiplos do épsilon do float na escala da pista. Só a ordem das operações (FMA, divisão)
+// muda entre CPU e GPU, então a tolerância é de alguns épsilons. As bordas só são comparadas
+// fora dos trechos colapsados pela correção de laços, que o shader não faz.
+static bool verificarParidade(RenderizadorEditor& renderizador, const TrackEditor& editor, float largura) {
+    const float TOLERANCIA_EPSILONS = 64.0f;
+
+    vector<vec2> curva, interna, externa;
+    if (!renderizador.lerCurvasDaGPU(editor, curva, interna, externa)) {
+        cout << endl << "[paridade] curva nao uniforme (adaptativa ou importada): sem avaliacao na GPU" << endl;
+        return true;
+    }
+
+    const vector<vec2>& curvaCPU = editor.obterPontosBSpline();
+    const vector<vec2>& internaCPU = editor.obterCurvaInterna();
+    const vector<vec2>& externaCPU = editor.obterCurvaExterna();
+    size_t numAmostras = curvaCPU.size();
+    if (curva.size() != numAmostras) {
+        cout << endl << "[paridade] o shader calcula " << curva.size() << " amostras e o editor tem "
+             << numAmostras << " (resolucoes diferentes)  FALHOU" << endl;
+        return false;
+    }
+    bool temBordas = internaCPU.size() == numAmostras && externaCPU.size() == numAmostras;
+
+    vector<char> colapsadaInterna(numAmostras, 0), colapsadaExterna(numAmostras, 0);
+    for (const TrechoCorrigido& t : editor.obterTrechosCorrigidos()) {
+        vector<char>& colapsada = t.interna ? colapsadaInterna : colapsadaExterna;
+        for (int k = 0; k < t.quantidade; k++) colapsada[(t.inicio + k) % numAmostras] = 1;
+    }
+
+    float escala = largura / 2.0f;
+    for (const vec2& p : curvaCPU) escala = std::max(escala, std::max(fabs(p.x), fabs(p.y)));
+
+    float erroCurva = 0.0f, erroBordas = 0.0f;
+    size_t comparadas = 0;
+    for (size_t i = 0; i < numAmostras; i++) {
+        erroCurva = std::max(erroCurva, length(curva[i] - curvaCPU[i]));
+        if (!temBordas) continue;
+        if (!colapsadaInterna[i]) erroBordas = std::max(erroBordas, length(interna[i] - internaCPU[i]));
+        if (!colapsadaExterna[i]) erroBordas = std::max(erroBordas, length(externa[i] - externaCPU[i]));
+        comparadas += !colapsadaInterna[i] + !colapsadaExterna[i];
+    }
+
+    float epsilon = escala * FLT_EPSILON;
+    bool ok = erroCurva <= TOLERANCIA_EPSILONS * epsilon && erroBordas <= TOLERANCIA_EPSILONS * epsilon;
+    cout << endl << "[paridade] " << numAmostras << " amostras da curva, " << comparadas << " das bordas" << endl;
+    cout << "  erro maximo: curva " << erroCurva << " (" << erroCurva / epsilon << " eps), bordas "
+         << erroBordas << " (" << erroBordas / epsilon << " eps); tolerancia " << TOLERANCIA_EPSILONS << " eps"
+         << (ok ? "" : "  FALHOU") << endl;
+    return ok;
+}
+
+
+// Valor abaixo do qual fica a fração p das amostras (p = 1: o máximo)
+static double percentil(vector<double> valores, double p) {
+    if (valores.empty()) return 0.0;
+    size_t k = std::min(valores.size() - 1, size_t(p * (valores.size() - 1) + 0.5));
+    nth_element(valores.begin(), valores.begin() + k, valores.end());
+    return valores[k];
+}
+
+
+// Mostra os pontos de controle e as curvas inteiras, como a tecla V do editor
+static void enquadrar(const TrackEditor& editor, CameraEditor& camera) {
+    vec2 minimo(INFINITY), maximo(-INFINITY);
+    for (const vector<vec2>* pontos : { &editor.obterPontosDeControle(), &editor.obterPontosBSpline(),
+                                        &editor.obterCurvaInterna(), &editor.obterCurvaExterna() }) {
+        for (const vec2& p : *pontos) {
+            minimo = min(minimo, p);
+            maximo = max(maximo, p);
+        }
+    }
+    camera.enquadrar(minimo, maximo);
+}
+
+
+// Oval ondulada com 'numPontos' pontos de controle. O tamanho cresce com a quantidade de
+// pontos (espaçamento constante), então as bordas na largura padrão não se cruzam.
+static void gerarPistaSintetica(int numPontos, vector<vec2>& pontos) {
+    float escala = std::max(1.0f, numPontos / 40.0f);
+    pontos.clear();
+    for (int i = 0; i < numPontos; i++) {
+        float t = 6.2831853f * i / numPontos;
+        pontos.push_back(escala * vec2(3.5f * cos(t) * (1.0f + 0.15f * sin(5.0f * t)), 3.0f * sin(t)));
+    }
+}
+
+
+static bool lerOpcoes(int argc, char** argv, OpcoesHeadless& opcoes) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool temValor = i + 1 < argc;
+        if (arg == "-o" && temValor) {
+            opcoes.prefixo = argv[++i];
+        } else if (arg == "-c" && temValor) {
+            opcoes.csv = argv[++i];
+        } else if (arg == "-n" && temValor) {
+            opcoes.quadros = atoi(argv[++i]);
+        } else if (arg == "-l" && temValor) {
+            opcoes.largura = atoi(argv[++i]);
+        } else if (arg == "-a" && temValor) {
+            opcoes.altura = atoi(argv[++i]);
+        } else if (arg == "-s" && temValor) {
+            opcoes.pontosSinteticos = atoi(argv[++i]);
+        } else if (arg == "-t" && temValor) {
+            opcoes.rastreamento = argv[++i];
+        } else if (arg == "-g") {
+            opcoes.curvasNaGPU = true;
+        } else if (arg[0] != '-') {
+            opcoes.projeto = arg;
+        } else {
+            opcoes.quadros = 0;     // Opção desconhecida: mostra o uso
+            break;
+        }
+    }
+    if (opcoes.quadros <= 0 || opcoes.largura <= 0 || opcoes.altura <= 0 || opcoes.pontosSinteticos < 0) {
+        cerr << "Uso: " << argv[0] << " [projeto.proj] [-o prefixo] [-n quadros] [-l largura] [-a altura]"
+             << " [-s pontos] [-c tempos.csv] [-g] [-t rastreamento.json]" << endl;
+        return false;
+    }
+    return true;
+}
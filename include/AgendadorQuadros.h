@@ -0,0 +1,40 @@
+#ifndef AGENDADORQUADROS_H
+#define AGENDADORQUADROS_H
+
+#include <cstdint>
+
+// Decide quando redesenhar a janela do editor. Só há quadro quando algo mudou (entrada do
+// usuário, edição, janela redimensionada ou exposta), e no máximo 'quadrosPorSegundo' por
+// segundo. Entre um quadro e outro o loop principal fica bloqueado esperando eventos pelo
+// tempo de espera() (glfwWaitEvents / glfwWaitEventsTimeout) em vez de girar com
+// glfwPollEvents: com o editor parado ele não ocupa CPU nem GPU.
+// Tempos em segundos, no relógio do loop (glfwGetTime). Não depende da GLFW.
+class AgendadorQuadros {
+public:
+    explicit AgendadorQuadros(double quadrosPorSegundo = 60.0) { definirLimite(quadrosPorSegundo); }
+
+    // Limite de quadros por segundo (0 = sem limite)
+    void definirLimite(double quadrosPorSegundo);
+
+    // Algo mudou: redesenhar no próximo quadro permitido
+    void marcar() { pendente = true; }
+
+    // Há quadro pendente e o intervalo mínimo desde o anterior já passou
+    bool redesenharAgora(double agora) const { return pendente && agora >= proximoQuadro; }
+
+    void quadroDesenhado(double agora);
+
+    // Quanto esperar por eventos: até o próximo quadro permitido quando há um pendente
+    // (0 = não esperar), ou indefinidamente (valor negativo) quando não há
+    double espera(double agora) const;
+
+    uint64_t obterQuadrosDesenhados() const { return quadrosDesenhados; }
+
+private:
+    double intervaloMinimo = 0.0;
+    double proximoQuadro = 0.0;
+    bool pendente = true;           // O primeiro quadro sempre é desenhado
+    uint64_t quadrosDesenhados = 0;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef ARENARASCUNHO_H
+#define ARENARASCUNHO_H
+
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <cstddef>
+
+using namespace std;
+
+// Arena para os buffers temporários (rascunho) das etapas de geração.
+// É um std::pmr::monotonic_buffer_resource sobre um bloco que persiste entre as gerações:
+// alocar só avança um ponteiro e nada é liberado até reiniciar(), que descarta tudo de uma
+// vez. Se uma geração precisou de mais memória que o bloco, o excedente veio do heap e o
+// bloco cresce na reinicialização seguinte; com tamanhos estáveis (edição interativa) não
+// há nenhuma alocação no heap. Não é thread-safe: alocar só na thread que chama paraCada.
+class ArenaRascunho {
+public:
+    ArenaRascunho();
+
+    pmr::memory_resource* recurso() { return &*monotonico; }
+
+    // Libera tudo o que foi alocado e, se houve excedente, aumenta o bloco
+    void reiniciar();
+
+    size_t capacidade() const { return tamanhoBloco; }
+
+private:
+    // Recurso de reserva do monotônico: repassa ao heap e soma o que foi pedido
+    class Excedente : public pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+    private:
+        void* do_allocate(size_t tamanho, size_t alinhamento) override;
+        void do_deallocate(void* p, size_t tamanho, size_t alinhamento) override;
+        bool do_is_equal(const pmr::memory_resource& outro) const noexcept override { return this == &outro; }
+    };
+
+    unique_ptr<byte[]> bloco;
+    size_t tamanhoBloco = 0;
+    Excedente excedente;
+    optional<pmr::monotonic_buffer_resource> monotonico;
+};
+
+#endif
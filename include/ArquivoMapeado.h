@@ -0,0 +1,37 @@
+#ifndef ARQUIVOMAPEADO_H
+#define ARQUIVOMAPEADO_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// Arquivo inteiro mapeado na memória, só para leitura (mmap / MapViewOfFile). Abrir custa
+// só o mapeamento; as páginas são lidas do disco quando acessadas. Usado pelo leitor de
+// .trk e pelos importadores de OBJ e curva. O ponteiro vale até fechar() ou o destrutor.
+class ArquivoMapeado {
+public:
+    ArquivoMapeado() = default;
+    ~ArquivoMapeado();
+
+    ArquivoMapeado(const ArquivoMapeado&) = delete;
+    ArquivoMapeado& operator=(const ArquivoMapeado&) = delete;
+
+    // Mapeia o arquivo; em caso de erro (inclusive arquivo vazio) informa no console e retorna false
+    bool abrir(const string& caminho);
+    void fechar();
+    bool aberto() const { return base != nullptr; }
+
+    const unsigned char* dados() const { return base; }
+    size_t tamanho() const { return bytes; }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t bytes = 0;
+#ifdef _WIN32
+    void* arquivo = nullptr;       // HANDLE do arquivo
+    void* mapeamento = nullptr;    // HANDLE do mapeamento
+#endif
+};
+
+#endif
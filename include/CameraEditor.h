@@ -0,0 +1,42 @@
+#ifndef CAMERAEDITOR_H
+#define CAMERAEDITOR_H
+
+#include <glm/glm.hpp>
+
+using namespace glm;
+
+// Câmera 2D do editor: centro e meia altura visível em unidades de mundo, com a largura
+// dada pela proporção da janela. Sem limite de escala fixo: pistas de poucos metros ou de
+// vários quilômetros são editadas com zoom e deslocamento.
+class CameraEditor {
+public:
+    // Tamanho do framebuffer em pixels
+    void definirJanela(int largura, int altura);
+
+    // Posição do cursor (coordenadas da janela, origem no canto superior esquerdo, em uma
+    // janela de larguraTela x alturaTela) para o mundo
+    vec2 telaParaMundo(double x, double y, int larguraTela, int alturaTela) const;
+
+    // Aproxima (fator > 1) ou afasta (fator < 1) mantendo o ponto 'ancora' no mesmo lugar da tela
+    void aplicarZoom(float fator, vec2 ancora);
+
+    // Desloca a vista em unidades de mundo
+    void deslocar(vec2 delta) { centro += delta; }
+
+    // Ajusta a vista para mostrar a caixa [minimo, maximo] inteira, com margem
+    void enquadrar(vec2 minimo, vec2 maximo);
+
+    mat4 obterProjecao() const;
+    vec2 obterMinimoVisivel() const;
+    vec2 obterMaximoVisivel() const;
+    float obterTamanhoPixel() const { return 2.0f * meiaAltura / altura; }   // Unidades de mundo por pixel
+
+private:
+    vec2 centro = vec2(0.0f);
+    float meiaAltura = 5.0f;        // ±5 unidades na vertical, como a vista original
+    int largura = 1, altura = 1;
+
+    float proporcao() const { return (float)largura / (float)altura; }
+};
+
+#endif
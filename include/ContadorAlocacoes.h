@@ -0,0 +1,18 @@
+#ifndef CONTADORALOCACOES_H
+#define CONTADORALOCACOES_H
+
+#include <cstddef>
+
+// Quantidade de alocações no heap desde o início do programa.
+// Só compilando com -DTRACK_CONTAR_ALOCACOES: o operator new global é substituído em
+// ContadorAlocacoes.cpp e conta todas as chamadas; a diferença entre duas leituras mostra
+// se um trecho alocou memória. Sem a opção o new/delete é o da biblioteca e o total é 0.
+size_t obterTotalDeAlocacoes();
+
+#ifdef TRACK_CONTAR_ALOCACOES
+const bool CONTAGEM_DE_ALOCACOES = true;
+#else
+const bool CONTAGEM_DE_ALOCACOES = false;
+#endif
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef CONTEXTOOFFSCREEN_H
+#define CONTEXTOOFFSCREEN_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Contexto OpenGL sem janela e sem servidor gráfico, para o modo headless (headless.cpp):
+// EGL na plataforma "surfaceless" da Mesa (llvmpipe serve, sem GPU), desenhando em um FBO
+// do tamanho pedido. Só depende da libEGL; o editor continua criando o contexto pela GLFW.
+class ContextoOffscreen {
+public:
+    ContextoOffscreen() = default;
+    ~ContextoOffscreen() { destruir(); }
+
+    ContextoOffscreen(const ContextoOffscreen&) = delete;
+    ContextoOffscreen& operator=(const ContextoOffscreen&) = delete;
+
+    // Cria o contexto (OpenGL 3.3 core), carrega a GLAD e deixa o FBO ligado
+    bool criar(int largura, int altura);
+
+    void destruir();
+
+    // Cor do FBO em RGBA, com a primeira linha no topo (como o PNG espera); espera a GPU
+    void lerPixels(vector<uint8_t>& rgba) const;
+
+    // Nome do renderizador OpenGL (ex.: "llvmpipe (LLVM 15.0.6, 256 bits)")
+    string obterRenderizador() const;
+
+private:
+    void* display = nullptr;    // EGLDisplay / EGLContext (sem expor os cabeçalhos da EGL)
+    void* contexto = nullptr;
+    GLuint fbo = 0, cor = 0;
+    int largura = 0, altura = 0;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef ESCRITORPNG_H
+#define ESCRITORPNG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Grava uma imagem RGBA de 8 bits por canal em PNG, sem depender de zlib: os dados vão
+// em blocos deflate sem compressão ("stored"), então o arquivo fica do tamanho da imagem
+// (cerca de 3 MB em 1024x768), mas é gravado em uma passada e lido por qualquer
+// visualizador ou ferramenta de comparação.
+// 'rgba' tem largura * altura * 4 bytes, com a primeira linha no topo da imagem.
+bool gravarPNG(const string& caminho, int largura, int altura, const vector<uint8_t>& rgba);
+
+#endif
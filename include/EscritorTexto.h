@@ -0,0 +1,95 @@
+#ifndef ESCRITORTEXTO_H
+#define ESCRITORTEXTO_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+// Escrita de arquivos texto grandes (OBJ, curva de animação) em blocos.
+// Os números são formatados com to_chars direto em um buffer contíguo, que só vai para o
+// arquivo (um write) quando enche: sem endl, que esvazia o stream a cada linha, e sem a
+// maquinaria de locale do iostream. Floats saem no formato geral com 6 algarismos
+// significativos, byte a byte iguais ao operator<< com a precisão padrão do stream.
+// Sem arquivo, acumula tudo na memória (o buffer cresce): usado para formatar blocos de
+// linhas em paralelo, que depois são gravados em ordem (ver exportarOBJ).
+class EscritorTexto {
+public:
+    explicit EscritorTexto(ofstream& arquivo, size_t tamanhoBuffer = size_t(1) << 20);
+    explicit EscritorTexto(size_t capacidadeInicial);
+    ~EscritorTexto();
+
+    // Movível (para guardar blocos em vector); o original fica vazio e sem arquivo
+    EscritorTexto(EscritorTexto&& outro) noexcept
+        : arquivo(outro.arquivo), buffer(std::move(outro.buffer)), usado(outro.usado) {
+        outro.arquivo = nullptr;
+        outro.usado = 0;
+    }
+
+    void texto(const char* s, size_t n) {
+        if (arquivo && n > buffer.size()) {
+            descarregar();
+            arquivo->write(s, n);
+            return;
+        }
+        garantir(n);
+        memcpy(&buffer[usado], s, n);
+        usado += n;
+    }
+    void texto(const char* s) { texto(s, strlen(s)); }
+    void texto(const string& s) { texto(s.data(), s.size()); }
+
+    void caractere(char c) {
+        garantir(1);
+        buffer[usado++] = c;
+    }
+
+    // Inteiros de qualquer tipo (índices, contagens)
+    template <typename Inteiro>
+    void inteiro(Inteiro valor) {
+        garantir(24);
+        usado = to_chars(&buffer[usado], buffer.data() + buffer.size(), valor).ptr - buffer.data();
+    }
+
+    // Equivalente a "arquivo << valor" com a precisão padrão (6)
+    void real(float valor) {
+        garantir(32);
+        usado = to_chars(&buffer[usado], buffer.data() + buffer.size(), valor,
+                         chars_format::general, 6).ptr - buffer.data();
+    }
+    void real(double valor) {
+        garantir(32);
+        usado = to_chars(&buffer[usado], buffer.data() + buffer.size(), valor,
+                         chars_format::general, 6).ptr - buffer.data();
+    }
+
+    // Menor representação que volta exatamente ao mesmo float (limites no JSON do glTF,
+    // que os validadores comparam com os dados)
+    void realExato(float valor) {
+        garantir(32);
+        usado = to_chars(&buffer[usado], buffer.data() + buffer.size(), valor).ptr - buffer.data();
+    }
+
+    // Grava o que está no buffer (sem arquivo, não faz nada)
+    void descarregar();
+
+    // Conteúdo acumulado no modo em memória
+    const char* dados() const { return buffer.data(); }
+    size_t tamanho() const { return usado; }
+    void limpar() { usado = 0; }
+
+private:
+    ofstream* arquivo = nullptr;
+    vector<char> buffer;
+    size_t usado = 0;
+
+    void garantir(size_t n) {
+        if (usado + n > buffer.size()) abrirEspaco(n);
+    }
+    void abrirEspaco(size_t n);
+};
+
+#endif
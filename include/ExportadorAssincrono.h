@@ -0,0 +1,59 @@
+#ifndef EXPORTADORASSINCRONO_H
+#define EXPORTADORASSINCRONO_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include "TrackEditor.h"
+
+using namespace std;
+
+// Exportação da pista em segundo plano, para que a janela não trave em pistas grandes.
+// iniciar() copia os dados do editor (InstantaneoPista) e grava os arquivos em uma thread
+// própria: OBJ (+ MTL), .trk e GLB em sequência e, ao mesmo tempo, a curva de animação em
+// outra thread. A edição pode continuar durante a exportação, já que o instantâneo não
+// muda. O loop principal chama atualizar() para informar progresso e conclusão no console;
+// o aviso de progresso o acorda quando ele está bloqueado esperando eventos.
+class ExportadorAssincrono {
+public:
+    ExportadorAssincrono() = default;
+    ~ExportadorAssincrono();   // Espera a exportação em andamento terminar
+
+    ExportadorAssincrono(const ExportadorAssincrono&) = delete;
+    ExportadorAssincrono& operator=(const ExportadorAssincrono&) = delete;
+
+    // Captura o instantâneo e inicia a exportação; retorna false se a anterior ainda não terminou
+    bool iniciar(TrackEditor& editor, const string& caminho, float espacamentoCurva);
+
+    bool emAndamento() const { return trabalhador.joinable() && !terminou; }
+
+    // Informa progresso (arquivos concluídos) e conclusão; chamar na thread principal
+    void atualizar();
+
+    // Chamado nas threads da exportação a cada arquivo concluído e no fim (precisa ser
+    // seguro entre threads, ex.: glfwPostEmptyEvent). Definir antes de iniciar().
+    void definirAvisoDeProgresso(function<void()> aviso) { avisoDeProgresso = move(aviso); }
+
+    // Bloqueia até a exportação em andamento terminar (ex.: ao fechar a janela)
+    void aguardar();
+
+private:
+    static constexpr int TOTAL_ARQUIVOS = 4;   // OBJ, .trk, GLB e curva
+
+    InstantaneoPista instantaneo;
+    thread trabalhador;
+    atomic<int> arquivosConcluidos{0};
+    atomic<int> falhas{0};
+    atomic<bool> terminou{false};
+    int progressoInformado = 0;
+    chrono::steady_clock::time_point inicio;
+    function<void()> avisoDeProgresso;
+
+    void executar(string caminho, float espacamentoCurva);
+    void registrar(bool sucesso);
+    void concluir();
+};
+
+#endif
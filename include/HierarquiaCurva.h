@@ -0,0 +1,58 @@
+#ifndef HIERARQUIACURVA_H
+#define HIERARQUIACURVA_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+// Amostras por folha da hierarquia (cada nível acima junta dois nós)
+const int AMOSTRAS_POR_FOLHA_HIERARQUIA = 32;
+
+// Hierarquia de caixas mín/máx sobre as amostras de uma curva fechada, para desenhar só o
+// que aparece na vista: trechos fora da vista são descartados e trechos menores que um
+// pixel viram um único vértice. A quantidade de índices selecionados depende do tamanho
+// da curva na tela, não da quantidade de amostras.
+class HierarquiaCurva {
+public:
+    // Refaz a hierarquia inteira (O(n))
+    void construir(const vector<vec2>& pontos);
+
+    // Atualiza as caixas das amostras [inicio, fim) e dos nós acima delas
+    void atualizar(const vector<vec2>& pontos, int inicio, int fim);
+
+    // Acrescenta a 'indices' os índices (base + amostra) a desenhar como GL_LINE_STRIP na
+    // vista [minimo, maximo], com 'quebra' (reinício de primitiva) entre os trechos visíveis.
+    // O erro em relação à curva completa fica abaixo de tamanhoPixel (unidades de mundo).
+    void selecionar(vec2 minimo, vec2 maximo, float tamanhoPixel, uint32_t base, uint32_t quebra,
+                    vector<uint32_t>& indices) const;
+
+    int obterNumeroDeAmostras() const { return numAmostras; }
+
+private:
+    struct Caixa {
+        vec2 minimo, maximo;
+    };
+
+    struct Selecao {
+        vec2 minimo, maximo;
+        float limiar;
+        uint32_t base, quebra;
+        vector<uint32_t>* indices;
+        bool aberto;            // Há um trecho visível em andamento
+        int ultimoOculto;       // Última amostra do trecho descartado mais recente (-1 = nenhum)
+    };
+
+    int numAmostras = 0;
+    vector<Caixa> caixas;       // Todos os níveis, das folhas até a raiz (com a amostra seguinte a cada nó)
+    vector<int> inicioNivel;    // Primeiro nó de cada nível em caixas (+ o total no fim)
+
+    Caixa caixaFolha(const vector<vec2>& pontos, int folha) const;
+    void atualizarFolhas(const vector<vec2>& pontos, int primeiro, int ultimo);
+    void atualizarNo(int nivel, int j);
+    void visitar(int nivel, int j, Selecao& s) const;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef IMPORTADORPISTA_H
+#define IMPORTADORPISTA_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TrackEditor.h"
+
+using namespace std;
+using namespace glm;
+
+// Leitura dos arquivos texto da pista (OBJ e curva de animação), gerados pelo editor ou
+// por outras ferramentas. O arquivo é mapeado na memória (ArquivoMapeado) e dividido em
+// blocos de linhas inteiras, interpretados em paralelo com from_chars; os blocos são
+// juntados na ordem, então o resultado é o mesmo para qualquer quantidade de threads.
+// Os números lidos voltam ao mesmo texto na exportação: exportar, importar e exportar de
+// novo gera arquivos iguais byte a byte. Em caso de erro informa no console (com a linha)
+// e retorna false sem alterar os vetores de saída.
+
+// OBJ com v, vt, vn e faces em qualquer das formas v, v/vt, v//vn ou v/vt/vn, com índices
+// negativos (relativos) e polígonos (divididos em leque). Posições e normais voltam do
+// sistema do visualizador (Y <-> Z) para o do editor. Quando cada face usa o mesmo índice
+// para v, vt e vn (como no OBJ do editor) os vértices são os do arquivo, na mesma ordem;
+// caso contrário cada combinação v/vt/vn distinta vira um vértice. Outras diretivas
+// (o, g, s, usemtl, mtllib...) são ignoradas. comNormais informa se havia normais.
+bool lerOBJ(const string& caminho, vector<Vertex>& vertices, vector<Triangle>& triangles,
+            bool* comNormais = nullptr);
+
+// Curva de animação (track_curve.txt): uma linha "x altura z" por amostra, comentários com #.
+// Devolve as amostras no plano do editor (x, z) e a altura de cada uma.
+bool lerCurvaAnimacao(const string& caminho, vector<vec2>& pontos, vector<float>& alturas);
+
+#endif
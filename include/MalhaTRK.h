@@ -0,0 +1,78 @@
+#ifndef MALHATRK_H
+#define MALHATRK_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "TrackEditor.h"
+#include "ArquivoMapeado.h"
+
+using namespace std;
+
+// Formato binário .trk da malha da pista (little-endian), feito para ser mapeado na memória
+// e usado direto, sem cópia nem parsing:
+//   CabecalhoTRK | Vertex[numVertices] | uint32_t[numIndices] | BlocoTRK[numBlocos]
+// Cada seção começa em um deslocamento múltiplo de ALINHAMENTO_TRK. Os vértices já estão
+// no sistema do visualizador 3D (Y <-> Z, como no OBJ) e os índices formam triângulos
+// (3 por face, começando em 0). Os blocos são opcionais: faixas contíguas de índices com
+// a caixa envolvente dos seus vértices, para descarte por visibilidade.
+
+const char MAGIA_TRK[4] = { 'T', 'R', 'K', 'M' };
+const uint32_t VERSAO_TRK = 1;
+const uint32_t ALINHAMENTO_TRK = 64;
+
+struct CabecalhoTRK {
+    char magia[4];                  // MAGIA_TRK
+    uint32_t versao;                // VERSAO_TRK
+    uint32_t tamanhoCabecalho;      // sizeof(CabecalhoTRK)
+    uint32_t tamanhoVertice;        // sizeof(Vertex)
+    uint64_t numVertices;
+    uint64_t numIndices;
+    uint64_t numBlocos;             // 0 quando não há tabela de blocos
+    uint64_t deslocamentoVertices;  // Em bytes, a partir do início do arquivo
+    uint64_t deslocamentoIndices;
+    uint64_t deslocamentoBlocos;
+    float minimo[3];                // Caixa envolvente de todos os vértices
+    float maximo[3];
+    uint32_t reservado[2];
+};
+static_assert(sizeof(CabecalhoTRK) == 96, "CabecalhoTRK deve ter 96 bytes");
+static_assert(sizeof(Vertex) == 32, "Vertex deve ter 32 bytes (8 floats) no formato .trk");
+
+// Faixa de índices [primeiroIndice, primeiroIndice + numIndices) e sua caixa envolvente
+struct BlocoTRK {
+    uint32_t primeiroIndice;
+    uint32_t numIndices;
+    float minimo[3];
+    float maximo[3];
+};
+static_assert(sizeof(BlocoTRK) == 32, "BlocoTRK deve ter 32 bytes");
+
+// Leitor de .trk: mapeia o arquivo inteiro (ArquivoMapeado), valida o cabeçalho e
+// devolve ponteiros direto para as seções. Abrir custa só o mapeamento; as páginas são
+// lidas do disco quando acessadas. Os ponteiros valem até fechar() ou o destrutor.
+class ArquivoTRK {
+public:
+    // Mapeia e valida o arquivo; em caso de erro informa no console e retorna false
+    bool abrir(const string& caminho);
+    void fechar() { mapa.fechar(); }
+    bool aberto() const { return mapa.aberto(); }
+
+    const CabecalhoTRK& cabecalho() const { return *reinterpret_cast<const CabecalhoTRK*>(mapa.dados()); }
+
+    const Vertex* vertices() const { return reinterpret_cast<const Vertex*>(mapa.dados() + cabecalho().deslocamentoVertices); }
+    size_t numVertices() const { return cabecalho().numVertices; }
+
+    const uint32_t* indices() const { return reinterpret_cast<const uint32_t*>(mapa.dados() + cabecalho().deslocamentoIndices); }
+    size_t numIndices() const { return cabecalho().numIndices; }
+
+    const BlocoTRK* blocos() const { return reinterpret_cast<const BlocoTRK*>(mapa.dados() + cabecalho().deslocamentoBlocos); }
+    size_t numBlocos() const { return cabecalho().numBlocos; }
+
+private:
+    ArquivoMapeado mapa;
+
+    bool validar(const string& caminho) const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef NURBS_H
+#define NURBS_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+// Grau máximo suportado (define o tamanho dos buffers fixos na pilha)
+const int NURBS_GRAU_MAXIMO = 7;
+
+// Calcula as grau+1 funções de base não nulas no intervalo de nós 'intervalo'
+// (forma triangular iterativa de Cox-de Boor, sem recursão nem alocação)
+void calcularBasesNaoNulas(int intervalo, float t, int grau, const float* nos, float* N);
+
+// Curva NURBS de grau 2..7 com nós não uniformes e pesos racionais
+struct CurvaNURBS {
+    int grau = 3;
+    vector<vec2> pontos;    // Pontos de controle
+    vector<float> pesos;    // Pesos racionais (vazio = todos 1, B-Spline comum)
+    vector<float> nos;      // Vetor de nós (pontos.size() + grau + 1 valores, não decrescente)
+    
+    // Verifica grau, quantidade de nós/pesos e ordenação do vetor de nós
+    bool valida() const;
+    
+    // Domínio paramétrico válido [inicio, fim]
+    float inicio() const { return nos[grau]; }
+    float fim() const { return nos[pontos.size()]; }
+    
+    // Índice do intervalo de nós que contém t (busca binária)
+    int encontrarIntervalo(float t) const;
+    
+    // Avalia a curva em t
+    vec2 avaliar(float t) const;
+    
+    // Avalia a curva (e, se 'derivadas' não for nulo, a primeira derivada) em vários
+    // parâmetros de uma vez; com parâmetros crescentes o intervalo é reaproveitado
+    // entre amostras em vez de buscado novamente
+    void avaliarLote(const float* parametros, int quantidade, vec2* saida, vec2* derivadas = nullptr) const;
+    
+    // Monta uma curva fechada uniforme (equivalente à B-Spline cúbica do editor quando grau = 3)
+    static CurvaNURBS fechadaUniforme(const vector<vec2>& pontosFechados, int grau);
+};
+
+#endif
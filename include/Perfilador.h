@@ -0,0 +1,74 @@
+#ifndef PERFILADOR_H
+#define PERFILADOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Perfilador de etapas: zonas com escopo (PERFIL_ZONA) marcam o início e o fim de cada
+// etapa da geração, da exportação e do loop de desenho, e gravarRastreamento() grava o que
+// foi registrado no formato trace_event do Chrome (abrir em chrome://tracing ou no Perfetto).
+// Cada thread grava em um buffer circular próprio, sem trava: o registro é uma leitura do
+// relógio e três stores, e com o perfilador desligado a zona é só um teste de um atômico.
+// O buffer de uma thread é criado no primeiro registro dela (fora do caminho desligado) e
+// guarda os últimos EVENTOS_POR_THREAD eventos.
+// Com TRACK_SEM_PERFILADOR definido na compilação, as zonas não geram código nenhum.
+class Perfilador {
+public:
+    static const uint32_t EVENTOS_POR_THREAD = 1u << 16;   // Potência de 2
+
+    // Liga (descartando o que foi registrado antes) ou desliga o registro
+    static void ativar(bool ativo);
+    static bool ativo() { return ligado.load(memory_order_relaxed); }
+
+    // Nome da thread atual no rastreamento (ex.: "principal", "trabalhador 3")
+    static void nomearThread(const string& nome);
+
+    // Grava os eventos registrados desde ativar(true) em JSON trace_event. Pode ser chamado
+    // com o perfilador ligado: eventos sendo gravados ao mesmo tempo podem ficar de fora.
+    static bool gravarRastreamento(const string& caminho);
+
+    // Nanossegundos desde o início do programa (relógio monotônico)
+    static int64_t agora();
+
+    // Zona 'nome' (literal ou string estática) de 'inicio' a 'fim' na thread atual
+    static void registrar(const char* nome, int64_t inicio, int64_t fim);
+
+private:
+    static atomic<bool> ligado;
+};
+
+// Registra do construtor ao destrutor, se o perfilador estava ligado na entrada da zona
+class ZonaPerfil {
+public:
+    explicit ZonaPerfil(const char* nomeZona) {
+        if (Perfilador::ativo()) {
+            nome = nomeZona;
+            inicio = Perfilador::agora();
+        }
+    }
+    ~ZonaPerfil() {
+        if (nome) Perfilador::registrar(nome, inicio, Perfilador::agora());
+    }
+
+    ZonaPerfil(const ZonaPerfil&) = delete;
+    ZonaPerfil& operator=(const ZonaPerfil&) = delete;
+
+private:
+    const char* nome = nullptr;
+    int64_t inicio = 0;
+};
+
+#define PERFIL_CONCATENAR_(a, b) a##b
+#define PERFIL_CONCATENAR(a, b) PERFIL_CONCATENAR_(a, b)
+
+#ifdef TRACK_SEM_PERFILADOR
+#define PERFIL_ZONA(nome) ((void)0)
+#else
+// Zona do ponto da declaração até o fim do escopo
+#define PERFIL_ZONA(nome) ZonaPerfil PERFIL_CONCATENAR(zonaPerfil, __LINE__)(nome)
+#endif
+
+#endif
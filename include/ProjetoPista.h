@@ -0,0 +1,129 @@
+#ifndef PROJETOPISTA_H
+#define PROJETOPISTA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <glm/glm.hpp>
+
+using namespace std;
+using namespace glm;
+
+// Parâmetros de geração guardados no projeto. Para acrescentar um parâmetro: um campo
+// aqui (com o valor padrão) e um identificador novo em visitarParametros (ProjetoPista.cpp);
+// projetos antigos ficam com o padrão e os novos ignoram identificadores desconhecidos.
+struct ParametrosProjeto {
+    int pontosPorSegmento = 100;
+    float larguraDaPista = 1.0f;
+    bool tesselacaoAdaptativa = false;      // Alterna com a tecla A
+    float toleranciaCorda = 0.002f;         // Erro máximo de corda no modo adaptativo (unidades de mundo)
+    float toleranciaAngulo = 0.05f;         // Ângulo máximo por sub-intervalo no modo adaptativo (radianos)
+    float espacamentoCurvaAnimacao = 0.0f;  // Distância entre amostras de track_curve.txt (0 = amostras da B-Spline); tecla S
+    bool pontesAutomaticas = false;         // Alterna com a tecla P
+    float alturaPonte = 0.6f;               // Altura do ramo elevado nos cruzamentos (unidades de mundo)
+    float comprimentoRampa = 2.0f;          // Comprimento de cada rampa da ponte (unidades de mundo)
+    bool avaliacaoNaGPU = false;            // Curvas avaliadas no shader do editor; alterna com a tecla U
+    int grauCurva = 3;                      // Grau da B-Spline fechada (2..7) na tesselação fixa; tecla N
+};
+
+// Formato binário do projeto (little-endian): só pontos de controle e parâmetros, então
+// ler e gravar não dependem do tamanho da malha.
+//   CabecalhoProjeto | ParametroProjeto[numParametros] | vec2[numPontos]
+// Entre um salvamento e outro as edições vão para o diário (caminho + ".diario"):
+//   CabecalhoDiario | RegistroDiario...
+// Cada edição acrescenta um registro de tamanho fixo, então o salvamento automático custa
+// O(edição). O diário só vale para o projeto com a mesma geração; salvar o projeto
+// inteiro incrementa a geração e começa um diário vazio.
+
+const char MAGIA_PROJETO[4] = { 'T', 'R', 'K', 'P' };
+const char MAGIA_DIARIO[4] = { 'T', 'R', 'K', 'D' };
+const uint32_t VERSAO_PROJETO = 1;
+
+struct CabecalhoProjeto {
+    char magia[4];              // MAGIA_PROJETO
+    uint32_t versao;            // VERSAO_PROJETO
+    uint32_t tamanhoCabecalho;  // sizeof(CabecalhoProjeto)
+    uint32_t numParametros;
+    uint64_t geracao;           // Incrementada a cada salvamento completo
+    uint32_t numPontos;
+    uint32_t reservado;
+};
+static_assert(sizeof(CabecalhoProjeto) == 32, "CabecalhoProjeto deve ter 32 bytes");
+
+// Valor com os bits de um int32 ou float, conforme o parâmetro
+struct ParametroProjeto {
+    uint32_t id;
+    uint32_t valor;
+};
+static_assert(sizeof(ParametroProjeto) == 8, "ParametroProjeto deve ter 8 bytes");
+
+struct CabecalhoDiario {
+    char magia[4];              // MAGIA_DIARIO
+    uint32_t versao;            // VERSAO_PROJETO
+    uint64_t geracao;           // Geração do projeto a que o diário se aplica (0 = sem projeto salvo)
+};
+static_assert(sizeof(CabecalhoDiario) == 16, "CabecalhoDiario deve ter 16 bytes");
+
+enum TipoRegistroDiario : uint32_t {
+    DIARIO_ADICIONAR = 1,       // Novo ponto no fim: x, y
+    DIARIO_REMOVER_ULTIMO = 2,
+    DIARIO_MOVER = 3,           // indice, x, y
+    DIARIO_LIMPAR = 4,
+    DIARIO_PARAMETRO = 5        // indice = id do parâmetro, x = bits do valor
+};
+
+struct RegistroDiario {
+    uint32_t tipo;
+    int32_t indice;
+    uint32_t x, y;              // Bits dos floats
+};
+static_assert(sizeof(RegistroDiario) == 16, "RegistroDiario deve ter 16 bytes");
+
+// Projeto do editor em disco, com salvamento automático pelo diário
+class ProjetoPista {
+public:
+    explicit ProjetoPista(const string& caminho);
+
+    ProjetoPista(const ProjetoPista&) = delete;
+    ProjetoPista& operator=(const ProjetoPista&) = delete;
+
+    // Lê o projeto e reaplica o diário, e deixa o diário aberto para as próximas edições.
+    // Retorna false quando não há nada salvo (ou o projeto é inválido): começa vazio.
+    bool carregar(vector<vec2>& pontos, ParametrosProjeto& parametros);
+
+    // Só lê o projeto e o diário, sem abrir o diário para escrita nem criar arquivos
+    // (ferramentas que não editam o projeto, ex.: o modo headless)
+    bool ler(vector<vec2>& pontos, ParametrosProjeto& parametros);
+
+    // Grava o projeto inteiro (arquivo temporário + rename, nunca fica pela metade) e
+    // começa um diário novo
+    bool salvar(const vector<vec2>& pontos, const ParametrosProjeto& parametros);
+
+    // Edições, uma por registro no diário
+    void registrarAdicao(vec2 ponto);
+    void registrarRemocao();
+    void registrarMovimento(int indice, vec2 ponto);
+    void registrarLimpeza();
+    void registrarParametros(const ParametrosProjeto& parametros);   // Só os que mudaram
+
+    // Diário maior que o próprio projeto: hora de salvar tudo (mantém a leitura O(projeto)
+    // e o custo por edição O(1) amortizado)
+    bool diarioLongo(size_t numPontos) const;
+
+private:
+    string caminho;
+    string caminhoDiario;
+    ofstream diario;
+    uint64_t geracao = 0;
+    size_t registrosDiario = 0;
+    ParametrosProjeto parametrosDiario;     // Parâmetros como o projeto + diário os deixam
+
+    bool lerProjeto(vector<vec2>& pontos, ParametrosProjeto& parametros);
+    bool lerDiario(vector<vec2>& pontos, ParametrosProjeto& parametros);
+    void iniciarDiario();
+    void registrar(const RegistroDiario& registro);
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef RENDERIZADOREDITOR_H
+#define RENDERIZADOREDITOR_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "TrackEditor.h"
+#include "CameraEditor.h"
+#include "HierarquiaCurva.h"
+
+using namespace std;
+using namespace glm;
+
+// Desenho 2D do editor: pontos de controle, curva B-Spline e bordas da pista.
+// As quatro camadas ficam em um único VBO, cada uma na sua região, que fica na GPU entre
+// os quadros: só as camadas cuja geração mudou no TrackEditor são reenviadas, e depois de
+// uma edição incremental só os trechos de amostras alterados (glBufferSubData). Os
+// vértices são as posições (vec2) do editor, sem conversão; o shader escolhe a cor da
+// camada pelo índice do vértice (uniforms).
+// As curvas são desenhadas por índices escolhidos conforme a vista (HierarquiaCurva): só os
+// trechos visíveis, e um vértice por trecho menor que um pixel, então o custo do quadro
+// depende do tamanho da janela e não da quantidade de amostras. As três curvas saem em um
+// único glDrawElements (GL_LINE_STRIP com reinício de primitiva) e os pontos em um
+// glDrawArrays.
+// Com a avaliação na GPU ligada e uma curva uniforme, as curvas não saem do VBO: o vertex
+// shader avalia a B-Spline e as bordas a partir dos pontos de controle (gl_VertexID), então
+// arrastar um ponto envia só o ponto, e resolução e largura são uniforms
+// (definirParametrosGPU), sem amostras calculadas na CPU.
+class RenderizadorEditor {
+public:
+    RenderizadorEditor() = default;
+
+    RenderizadorEditor(const RenderizadorEditor&) = delete;
+    RenderizadorEditor& operator=(const RenderizadorEditor&) = delete;
+
+    // Cria o programa de shader e os buffers; precisa do contexto OpenGL atual (GLAD carregado)
+    bool inicializar(int largura, int altura);
+
+    // Libera os objetos OpenGL (antes de destruir o contexto)
+    void finalizar();
+
+    // Viewport: no início e quando a janela muda de tamanho
+    void redimensionar(int largura, int altura);
+
+    // Vista a desenhar; a projeção e os índices das curvas só são refeitos quando ela muda
+    void definirCamera(const CameraEditor& novaCamera);
+
+    // Curvas avaliadas no vertex shader a partir dos pontos de controle quando a curva é a
+    // B-Spline uniforme (TrackEditor::curvaUniforme); as outras continuam vindo das
+    // amostras do editor. As bordas saem sem a correção de laços (corrigirAutoIntersecoes).
+    void definirAvaliacaoNaGPU(bool ativo);
+    bool obterAvaliacaoNaGPU() const { return avaliacaoNaGPU; }
+
+    // Amostras por segmento e largura da pista das curvas avaliadas no shader (só uniforms:
+    // nada é recalculado nem reenviado). Largura 0 desenha só a curva, sem as bordas.
+    void definirParametrosGPU(int resolucao, float largura);
+
+    // As curvas do editor são desenhadas pelo shader: as amostras dele não precisam estar
+    // atualizadas para o desenho
+    bool curvasNaGPU(const TrackEditor& editor) const;
+
+    // Amostras da curva e das bordas como o shader as calcula (transform feedback), para
+    // comparar com as do editor gerado com os mesmos parâmetros. false quando a curva não é
+    // uniforme.
+    bool lerCurvasDaGPU(const TrackEditor& editor, vector<vec2>& curva,
+                        vector<vec2>& interna, vector<vec2>& externa);
+
+    // Desenha o editor, enviando à GPU só o que mudou desde o quadro anterior
+    void desenhar(const TrackEditor& editor);
+
+    // O editor ou a vista mudaram desde o último desenhar
+    bool desatualizado(const TrackEditor& editor) const;
+
+    // Bytes enviados à GPU no último desenhar (0 quando nada mudou)
+    size_t obterBytesEnviados() const { return bytesEnviados; }
+
+    // Índices das curvas desenhados no último quadro (inclui os reinícios de primitiva; 0 com
+    // as curvas avaliadas na GPU)
+    size_t obterIndicesDesenhados() const { return indicesDesenhados; }
+
+private:
+    // Camadas na ordem das regiões no VBO
+    enum { CAMADA_PONTOS, CAMADA_CURVA, CAMADA_INTERNA, CAMADA_EXTERNA, NUM_CAMADAS };
+
+    struct CamadaDesenho {
+        GLint inicio = 0;           // Primeiro vértice da região da camada no VBO
+        size_t capacidade = 0;      // Vértices que cabem na região
+        GLsizei quantidade = 0;     // Vértices enviados
+        uint64_t geracao = 0;       // Geração dos dados que estão no VBO (0 = nenhum)
+        HierarquiaCurva hierarquia; // Caixas das amostras (só nas curvas)
+    };
+
+    GLuint programa = 0;
+    GLint localProjecao = -1;
+    GLint localInicioCamada = -1;
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    CamadaDesenho camadas[NUM_CAMADAS];
+    size_t bytesEnviados = 0;
+
+    // Vista e índices das curvas
+    CameraEditor camera;
+    bool vistaAlterada = true;
+    bool indicesDesatualizados = true;
+    vector<uint32_t> indices;       // Mantém a capacidade entre quadros
+    size_t capacidadeIndices = 0;   // Índices que cabem no EBO
+    GLsizei quantidadeIndices = 0;
+    size_t indicesDesenhados = 0;
+
+    // Curvas avaliadas na GPU
+    GLuint programaGPU = 0;
+    GLint localProjecaoGPU = -1, localNumPontos = -1, localResolucao = -1, localMeiaLargura = -1;
+    GLuint texturaPontos = 0;       // Texture buffer sobre a região dos pontos de controle no VBO
+    GLuint vaoSemAtributos = 0;
+    bool avaliacaoNaGPU = false;
+    int resolucaoGPU = 0;
+    float larguraGPU = 0.0f;
+    uint64_t geracaoCurvasGPU = 0;  // Geração das curvas no último desenho pelo shader
+
+    void reservar(const vector<vec2>* const* dados);
+    void enviar(CamadaDesenho& camada, const vector<vec2>& dados, uint64_t geracao,
+                const vector<IntervaloAmostras>* trechos);
+    void selecionarIndices();
+    void enviarCamadas(const TrackEditor& editor, bool curvas);
+    void prepararProgramaGPU(const TrackEditor& editor);
+    void desenharCurvasNaGPU(const TrackEditor& editor);
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <type_traits>
+
+using namespace std;
+
+// Pool de threads com roubo de tarefas (work-stealing).
+// Cada thread tem sua própria fila: consome do fim da própria fila e, quando ela esvazia,
+// rouba do início das filas das outras. A thread que chama paraCada também executa tarefas:
+// cada chamador tem uma fila própria enquanto o lote dura e só executa blocos do próprio
+// lote, então o desenho e a exportação em segundo plano não executam blocos um do outro.
+// Em regime não há alocações no heap: as tarefas são registros simples (sem std::function)
+// e as filas mantêm a capacidade entre os lotes.
+class ThreadPool {
+public:
+    // numThreads = 0 usa a quantidade de núcleos da máquina (inclui a thread que chama)
+    explicit ThreadPool(int numThreads = 0);
+    ~ThreadPool();
+    
+    // Pool compartilhado usado pelas etapas de geração do TrackEditor
+    static ThreadPool& global();
+    
+    // Troca a quantidade de threads (não chamar enquanto houver paraCada em andamento)
+    void redimensionar(int numThreads);
+    
+    // Quantidade de threads que executam tarefas, incluindo a que chama paraCada
+    int obterNumeroDeThreads() const { return int(trabalhadores.size()) + 1; }
+    
+    // Divide [0, total) em blocos fixos de tamanhoBloco, executa func(inicio, fim) para cada
+    // bloco e espera todos terminarem. A divisão não depende da quantidade de threads, então
+    // etapas que só escrevem na própria fatia produzem sempre o mesmo resultado.
+    // Pode ser chamado de mais de uma thread ao mesmo tempo (lotes independentes).
+    // Uma exceção lançada por func é relançada aqui depois que os blocos em andamento
+    // terminam; os blocos que ainda não tinham começado são descartados.
+    template <typename Funcao>
+    void paraCada(int total, int tamanhoBloco, Funcao&& func) {
+        using Tipo = remove_reference_t<Funcao>;
+        executarLote(total, tamanhoBloco, [](const void* contexto, int inicio, int fim) {
+            (*static_cast<Tipo*>(const_cast<void*>(contexto)))(inicio, fim);
+        }, &func);
+    }
+    
+private:
+    using FuncaoBloco = void (*)(const void* contexto, int inicio, int fim);
+    
+    // Contador de blocos de um lote; decrementado sob o mutex para que o lote só seja
+    // destruído depois que a última tarefa terminou de sinalizar
+    struct Lote {
+        mutex m;
+        condition_variable terminou;
+        int restantes;
+        exception_ptr erro;             // Primeira exceção de um bloco (protegida por m)
+        atomic<bool> falhou{false};     // Os blocos seguintes são descartados
+    };
+    
+    // Um bloco de um lote: chama funcao(contexto, inicio, fim)
+    struct Tarefa {
+        FuncaoBloco funcao;
+        const void* contexto;
+        Lote* lote;
+        int inicio, fim;
+    };
+    
+    // Fila em vetor: o dono consome do fim, quem rouba consome a partir de 'frente'.
+    // Quando esvazia, volta ao início sem liberar a capacidade.
+    struct Fila {
+        mutex m;
+        vector<Tarefa> tarefas;
+        size_t frente = 0;
+        atomic<bool> ocupada{false};  // Vaga de chamador em uso (só nas filas de chamadores)
+    };
+    
+    // Chamadores de paraCada simultâneos com fila própria; além disso, o chamador só
+    // distribui entre os trabalhadores e ajuda roubando blocos do próprio lote
+    static const int VAGAS_CHAMADORES = 4;
+    
+    vector<unique_ptr<Fila>> filas;   // Uma por trabalhador, seguidas das vagas de chamadores
+    vector<thread> trabalhadores;
+    
+    mutex mutexSinal;
+    condition_variable sinal;         // Acorda trabalhadores quando chegam tarefas
+    atomic<int> tarefasNaFila{0};
+    bool parar = false;
+    
+    void iniciar(int numThreads);
+    void encerrar();
+    void executarTrabalhador(size_t indice);
+    bool tentarExecutar(size_t indice, const Lote* somente = nullptr);
+    size_t ocuparVaga();
+    void executarLote(int total, int tamanhoBloco, FuncaoBloco funcao, const void* contexto);
+};
+
+#endif
@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <memory_resource>
 #include <glm/glm.hpp>
+#include "NURBS.h"
+#include "ArenaRascunho.h"
 
 using namespace std;
 using namespace glm;
@@ -23,6 +27,36 @@ struct Triangle {
     int v1, v2, v3;  // Índices dos vértices
 };
 
+// Trecho de amostras de uma borda que formava um laço (dobra) e foi colapsado
+struct TrechoCorrigido {
+    bool interna;    // true = curva interna, false = curva externa
+    int inicio;      // Primeira amostra do trecho
+    int quantidade;  // Quantidade de amostras (o trecho pode dar a volta no fim da curva)
+};
+
+// Cruzamento da pista consigo mesma: dois ramos distantes ao longo da pista cujos quads
+// se sobrepõem (ex.: o centro de um "8"). Os trechos podem dar a volta no fim da pista.
+struct CruzamentoPista {
+    int inicioA, quantidadeA;  // Quads do primeiro ramo
+    int inicioB, quantidadeB;  // Quads do segundo ramo (o que vira ponte)
+    vec2 centro;               // Centro aproximado da sobreposição
+};
+
+// Intervalo [inicio, fim) de amostras da curva e das bordas
+struct IntervaloAmostras {
+    int inicio, fim;
+};
+
+// Cópia dos dados lidos pelas exportações (ver TrackEditor::capturarInstantaneo): não muda
+// enquanto a edição continua, então pode ser exportada em outra thread
+struct InstantaneoPista {
+    vector<Vertex> vertices;
+    vector<Triangle> triangles;
+    vector<vec2> pontosCurva;            // Amostras da B-Spline
+    vector<float> alturasAmostras;       // Alturas das pontes (vazio sem pontes)
+    vector<double> comprimentoAcumulado; // Tabela de comprimento de arco da curva (N + 1; vazia sem espaçamento)
+};
+
 class TrackEditor {
 public:
     TrackEditor();
@@ -37,12 +71,64 @@ public:
     // Limpa todos os pontos
     void limparPontosDeControle();
     
+    // Substitui todos os pontos de controle (projeto carregado); curva e malha são descartadas
+    void definirPontosDeControle(const vector<vec2>& pontos);
+    
+    // Move um ponto de controle existente e marca os segmentos afetados como alterados
+    void moverPontoDeControle(int indice, vec2 novaPosicao);
+    
+    // Índice do ponto de controle mais próximo de posicao dentro do raio (-1 se nenhum)
+    int encontrarPontoDeControle(vec2 posicao, float raio) const;
+    
+    // Regenera apenas os trechos da curva/bordas/malha afetados por pontos movidos; as
+    // pontes ficam para concluirEdicao (durante o arraste mantêm as alturas anteriores)
+    bool atualizarTrechosAlterados();
+    
+    // Fim de um arraste: aplica o último movimento e refaz as pontes dos cruzamentos
+    void concluirEdicao();
+    
     // Gera a curva B-Spline a partir dos pontos de controle
     void gerarBSpline(int resolution);
     
+    // Gera a curva B-Spline subdividindo cada segmento até atingir as tolerâncias de
+    // erro de corda (unidades de mundo) e de ângulo (radianos) por sub-intervalo
+    void gerarBSplineAdaptativa(float toleranciaDeCorda, float toleranciaDeAngulo);
+    
+    // Gera a curva a partir de uma NURBS geral (circuitos importados)
+    void gerarNURBS(const CurvaNURBS& curva, int resolution);
+    
+    // Gera a B-Spline fechada uniforme de grau 2..7 dos pontos de controle: grau 3 pelo
+    // avaliador cúbico (gerarBSpline), os outros pela NURBS equivalente. Com grau diferente
+    // de 3 cada edição regenera a curva inteira.
+    void gerarBSplineDeGrau(int grau, int resolution);
+    
+    // Caminho fundido: curva -> bordas -> malha em uma única passada, sem os vetores
+    // intermediários (bSplinePoints, innerCurve, outerCurve ficam vazios)
+    void gerarPistaFundida(int resolution, float trackWidth);
+    
+    // Preenche sob demanda a curva e as bordas depois de gerarPistaFundida (desenho da
+    // depuração, exportação e a primeira edição incremental)
+    void preencherCurvasDeDepuracao();
+    
     // Calcula as curvas interna e externa
     void calcularCurvasInternaExterna(float trackWidth);
     
+    // Detecta e colapsa os laços locais das curvas interna/externa (onde o raio da curva é
+    // menor que meia largura). Chamado por calcularCurvasInternaExterna quando ativo; o
+    // caminho fundido corrige as posições dos vértices e a edição incremental só a janela
+    // em volta das amostras alteradas.
+    int corrigirAutoIntersecoes();
+    void definirCorrecaoAutoIntersecao(bool ativo) { correcaoAutoIntersecao = ativo; }
+    const vector<TrechoCorrigido>& obterTrechosCorrigidos() const { return trechosCorrigidos; }
+    
+    // Detecta os cruzamentos da pista consigo mesma na malha atual (layout em faixa)
+    int detectarCruzamentos();
+    const vector<CruzamentoPista>& obterCruzamentos() const { return cruzamentosPista; }
+    
+    // Pontes automáticas: com ativo, toda malha gerada tem o ramo B de cada cruzamento
+    // elevado em 'altura', com rampas suaves de 'comprimentoRampa' (unidades de mundo)
+    void definirPontes(bool ativo, float altura, float comprimentoRampa);
+    
     // Triangulariza a malha da pista
     void triangularizarMalha();
     
@@ -50,31 +136,170 @@ public:
     void calcularNormais();
     
     // Exporta a pista para arquivo OBJ
-    bool exportarOBJ(const string& filename);
+    bool exportarOBJ(const string& filename) { return exportarOBJ(vertices, triangles, filename); }
+    
+    // Exporta a malha no formato binário .trk, carregável com mmap (ver MalhaTRK.h)
+    bool exportarTRK(const string& filename) { return exportarTRK(vertices, triangles, filename); }
+    
+    // Exporta a pista como glTF 2.0 binário (.glb), com o mesmo material do OBJ
+    bool exportarGLB(const string& filename) { return exportarGLB(vertices, triangles, filename); }
     
     // Exporta a curva para arquivo de animação
-    bool exportarCurvaAnimacao(const string& filename);
+    // (espacamento > 0: amostras igualmente espaçadas ao longo da curva, em unidades de mundo)
+    bool exportarCurvaAnimacao(const string& filename, float espacamento = 0.0f);
+    
+    // Importa a curva de um arquivo de animação (track_curve.txt, ver ImportadorPista.h) no
+    // lugar da pista atual: os pontos de controle, bordas e malha são descartados. As
+    // tangentes são estimadas por diferenças centrais, para gerar as bordas em seguida.
+    bool importarCurvaAnimacao(const string& filename);
+    
+    // Importa a malha de um OBJ (do editor ou de outra ferramenta) no lugar da malha atual
+    bool importarOBJ(const string& filename);
+    
+    // Copia malha e curva para 'destino' (mantendo a capacidade dos vetores dele), para
+    // exportar em segundo plano (ver ExportadorAssincrono); a tabela de comprimento só
+    // quando a curva vai ser exportada com espaçamento (espacamentoCurva > 0)
+    void capturarInstantaneo(InstantaneoPista& destino, float espacamentoCurva);
+    
+    // Exportações sobre dados explícitos, sem acessar o editor: podem rodar em outra thread
+    // com um InstantaneoPista. A curva com espaçamento precisa da tabela de comprimento.
+    static bool exportarOBJ(const vector<Vertex>& vertices, const vector<Triangle>& triangles, const string& filename);
+    static bool exportarTRK(const vector<Vertex>& vertices, const vector<Triangle>& triangles, const string& filename);
+    static bool exportarGLB(const vector<Vertex>& vertices, const vector<Triangle>& triangles, const string& filename);
+    static bool exportarCurvaAnimacao(const vector<vec2>& bSplinePoints, const vector<float>& alturasAmostras,
+                                      const vector<double>& comprimentoAcumulado,
+                                      const string& filename, float espacamento);
+    
+    // Tabela de comprimento de arco acumulado da curva (refeita sob demanda)
+    void calcularTabelaComprimento();
+    
+    // Posição na curva a uma distância (comprimento de arco) do início, em O(log n)
+    vec2 posicaoNaDistancia(float distancia);
+    
+    // Comprimento total da curva fechada
+    float obterComprimentoTotal();
+    
+    // Quantidade de threads usadas pelas etapas de geração (0 = um por núcleo).
+    // O resultado é o mesmo para qualquer quantidade de threads.
+    void definirNumeroDeThreads(int numThreads);
+    
+    // Liga/desliga o kernel vetorizado (SSE/AVX) de gerarBSpline; desligado usa o caminho escalar
+    void definirAvaliacaoVetorizada(bool ativo) { avaliacaoVetorizada = ativo; }
     
     // Getters para renderização
     const vector<vec2>& obterPontosDeControle() const { return pontosDeControle; }
     const vector<vec2>& obterPontosBSpline() const { return bSplinePoints; }
+    const vector<vec2>& obterDerivadasBSpline() const { return bSplineDerivadas; }
     const vector<vec2>& obterCurvaInterna() const { return innerCurve; }
     const vector<vec2>& obterCurvaExterna() const { return outerCurve; }
     const vector<Vertex>& obterVertices() const { return vertices; }
     const vector<Triangle>& obterTriangulos() const { return triangles; }
     
+    // Versões dos dados desenhados, incrementadas a cada alteração: o renderizador só
+    // reenvia à GPU o que mudou desde a versão que ele já tem
+    uint64_t obterGeracaoPontosDeControle() const { return geracaoPontos; }
+    uint64_t obterGeracaoCurvas() const { return geracaoCurvas; }   // Curva e bordas
+    
+    // Trechos da curva e das bordas alterados desde a geração 'desde' (sem sobreposição,
+    // fora de ordem). Retorna nullptr quando as curvas foram refeitas por inteiro depois
+    // dela (tamanho e índices podem ter mudado): nesse caso tudo precisa ser reenviado.
+    const vector<IntervaloAmostras>* obterAmostrasAlteradas(uint64_t desde) const;
+    
+    // A curva é a B-Spline cúbica uniforme dos pontos de controle (gerarBSpline): o shader do
+    // RenderizadorEditor a refaz só com os pontos, com a resolução e a largura dele. false para
+    // curva adaptativa, de outro grau, NURBS, importada ou não gerada.
+    bool curvaUniforme() const;
+    
 private:
     vector<vec2> pontosDeControle;     // Pontos de controle definidos pelo usuário
     vector<vec2> bSplinePoints;     // Pontos da curva B-Spline
+    vector<vec2> bSplineDerivadas;  // Primeira derivada (tangente) da curva em cada ponto
     vector<vec2> innerCurve;        // Pontos da curva interna
     vector<vec2> outerCurve;        // Pontos da curva externa
     vector<Vertex> vertices;        // Vértices da malha triangularizada
     vector<Triangle> triangles;     // Triângulos da malha
     
+    // Tabela dos pesos da base cúbica (b0..b3) e de suas derivadas (d0..d3)
+    // por amostra do segmento, em SoA
+    vector<float> tabelaB0, tabelaB1, tabelaB2, tabelaB3;
+    vector<float> tabelaD0, tabelaD1, tabelaD2, tabelaD3;
+    int resolucaoTabela = 0;          // Resolução para a qual a tabela foi calculada
+    bool avaliacaoVetorizada = true;  // Usa o kernel SIMD quando disponível
+    
+    // Parâmetros da última geração, usados na regeneração incremental
+    int resolucaoAtual = 0;
+    int grauAtual = 3;
+    bool modoAdaptativo = false;
+    float toleranciaCorda = 0.0f;
+    float toleranciaAngulo = 0.0f;
+    vector<int> inicioSegmento;       // Índice da primeira amostra de cada segmento (n + 1 valores)
+    vector<float> parametrosSegmento; // Parâmetros locais temporários do modo adaptativo
+    
+    // Comprimento de arco acumulado até cada amostra (N + 1 valores, o último é o total)
+    vector<double> comprimentoAcumulado;
+    bool tabelaComprimentoValida = false;
+    float larguraAtual = 0.0f;
+    bool normaisCalculadas = false;
+    bool malhaEmFaixa = false;        // Triângulos no layout de triangularizarMalha (2 por amostra)
+    
+    // Correção de auto-interseção das bordas
+    bool correcaoAutoIntersecao = true;
+    vector<TrechoCorrigido> trechosCorrigidos;  // Laços colapsados na última correção
+    vector<TrechoCorrigido> trechosRegravar;    // Temporário da regeneração incremental
+    
+    // Cruzamentos e pontes
+    bool pontesAutomaticas = false;
+    float alturaPonte = 0.0f;
+    float comprimentoRampa = 0.0f;
+    vector<CruzamentoPista> cruzamentosPista;
+    vector<float> alturasAmostras;    // Altura (Z) de cada amostra da malha com as pontes
+    bool pontesPendentes = false;     // Malha editada depois da última aplicarPontes
+    
+    // Segmentos (índice do primeiro ponto de controle) alterados desde a última atualização
+    vector<char> segmentoAlterado;
+    vector<int> segmentosPendentes;
+    
+    // Gerações para o desenho (ver obterAmostrasAlteradas): depois de geracaoBaseTrecho as
+    // curvas só mudaram nas amostras de trechosAlterados
+    uint64_t geracaoPontos = 1;
+    uint64_t geracaoCurvas = 1;
+    uint64_t geracaoBaseTrecho = 1;
+    vector<IntervaloAmostras> trechosAlterados;
+    
+    // Buffers temporários das etapas vêm da arena; ela é reiniciada quando termina a
+    // operação mais externa (as etapas chamam umas às outras)
+    ArenaRascunho rascunho;
+    int profundidadeRascunho = 0;
+    struct EscopoRascunho {
+        TrackEditor& editor;
+        explicit EscopoRascunho(TrackEditor& e) : editor(e) { editor.profundidadeRascunho++; }
+        ~EscopoRascunho() { if (--editor.profundidadeRascunho == 0) editor.rascunho.reiniciar(); }
+    };
+    
     // Funções auxiliares
-    vec2 avaliarBSpline(float t, int i);
-    float baseBSpline(int i, int k, float t);
-    vec2 calcularPerpendicular(vec2 p1, vec2 p2);
+    void prepararTabelaBase(int resolution);
+    void avaliarSegmentoEscalar(int i, int resolution, vec2* saida, vec2* derivadas);
+    void avaliarSegmentoVetorizado(int i, int resolution, vec2* saida, vec2* derivadas);
+    void descartarTrechosAlterados();
+    void descartarPista();
+    void marcarCurvasAlteradas();
+    void marcarAmostrasAlteradas(int inicio, int quantidade);
+    void acrescentarTrechoAlterado(int inicio, int fim);
+    void regenerarCompleto();
+    void parametrosAdaptativos(int i, vector<float>& us);
+    void avaliarCurvaUniforme(int resolution);
+    void calcularBordas(vec2 current, vec2 derivada, vec2& innerPoint, vec2& outerPoint);
+    void calcularBordasAmostra(int i);
+    void corrigirLacosCurva(vec2* curva, int numPoints, bool interna, int inicio, int quantidade);
+    void corrigirLacosAlterados();
+    void calcularDistanciasMalha(pmr::vector<double>& distancia) const;
+    void aplicarPontes();
+    void escreverAmostraMalha(int i, int numPoints, vec2 innerPoint, vec2 outerPoint);
+    void preencherVerticesAmostra(int i);
+    void recalcularNormaisAmostra(int i);
+    void avaliarBSpline(int i, const float* us, int quantidade,
+                        vec2* posicoes, vec2* derivadas, vec2* derivadasSegundas);
+    vec2 calcularPerpendicular(vec2 tangente);
     float calcularAngulo(vec2 v1, vec2 v2);
 };
 
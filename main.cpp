@@ -17,10 +17,15 @@
 #include <glad/glad.h> 	// biblioteca de funções baseada nas definições/especificações OPENGL - Incluir antes de outros que requerem OpenGL (como GLFW)
 #include <GLFW/glfw3.h> // biblioteca de funções para criação da janela no Windows e gerenciar entrada de teclado/mouse
 #include <glm/glm.hpp>	// biblioteca de operações matriciais
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
 #include "TrackEditor.h"
+#include "RenderizadorEditor.h"
+#include "AgendadorQuadros.h"
+#include "CameraEditor.h"
+#include "ExportadorAssincrono.h"
+#include "ProjetoPista.h"
+#include "ContadorAlocacoes.h"
+#include "Perfilador.h"
 
 using namespace std;	// Para não precisar digitar std:: na frente de comandos da biblioteca
 using namespace glm;	// Para não precisar digitar glm:: na frente de comandos da biblioteca
@@ -28,41 +33,67 @@ using namespace glm;	// Para não precisar digitar glm:: na frente de comandos d
 // Configurações de exportação de arquivos
 const string OUTPUT_PATH = "../GrauB_Vizualizador_3D/models/";
 
+// Projeto do editor (pontos de controle e parâmetros), salvo automaticamente
+const string PROJECT_PATH = "track.proj";
+
+// Rastreamento das etapas (tecla R), para abrir em chrome://tracing ou no Perfetto
+const string TRACE_PATH = "track_trace.json";
+
+// Distância entre as amostras de track_curve.txt com a reamostragem ligada (tecla S)
+const float ESPACAMENTO_CURVA_ANIMACAO = 0.05f;
+
 // Configurações da janela
 const unsigned int SCREEN_WIDTH = 1024;
 const unsigned int SCREEN_HEIGHT = 768;
+const double MAX_FPS = 60.0;            // Limite de quadros por segundo (0 = sem limite)
 
 // Editor de pista
 TrackEditor trackEditor;
-const int pontosPorSegmento = 100;
-const float larguraDaPista = 1.0f;
-
-// Programa de shader e buffers
-GLuint shaderProgram = 0;
-GLuint pointsVAO = 0, pointsVBO = 0;
-GLuint linesVAO = 0, linesVBO = 0;
+ParametrosProjeto parametros;           // Parâmetros de geração (valores padrão em ProjetoPista.h)
+ProjetoPista projeto(PROJECT_PATH);     // Cada edição vai para o diário do projeto
+bool projetoDesanexado = false;         // Pista importada (tecla I): o projeto em disco fica como estava
+ExportadorAssincrono exportador;        // Grava os arquivos em segundo plano (tecla E)
+
+// Desenho do editor (buffers na GPU, reenviados só quando o editor muda)
+RenderizadorEditor renderizador;
+int larguraJanela = SCREEN_WIDTH;   // Tamanho atual da janela (coordenadas do cursor)
+int alturaJanela = SCREEN_HEIGHT;
+CameraEditor camera;                // Zoom (roda do mouse) e deslocamento (botão do meio)
+AgendadorQuadros agendador(MAX_FPS);    // Só redesenha quando algo mudou
+bool vsyncAdaptativo = false;       // Driver aceita intervalo de troca -1 (adaptativo)
+bool curvasDeDepuracao = false;     // Desenha curva e bordas do caminho fundido (tecla D)
 
 // Estado do mouse
 bool mousePressed = false;
 double lastMouseX = 0.0;
 double lastMouseY = 0.0;
+int pontoArrastado = -1;            // Índice do ponto de controle sendo arrastado (-1 = nenhum)
+const float raioSelecaoPixels = 15.0f; // Raio (em pixels, qualquer zoom) para selecionar um ponto
+bool deslocandoVista = false;       // Botão do meio pressionado
+vec2 ancoraDeslocamento;            // Ponto do mundo que acompanha o cursor durante o deslocamento
+size_t alocacoesInicioArraste = 0;  // Contador de alocações no heap quando o arraste começou (-DTRACK_CONTAR_ALOCACOES)
 
 // Funções de Callback
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 // Funções auxiliares
-void setupBuffers();
-void renderEditor();
+void salvarProjetoSeNecessario();
+void reanexarProjeto();
+void concluirArraste();
+void enquadrarPista();
 vec2 screenToWorld(double xpos, double ypos);
-GLuint createShaderProgram();
 
 
 int main() {
 
     cout << "    Editor de Pista de Corrida - CGR    " << endl;
     cout << endl;
+    Perfilador::nomearThread("principal");
 
     // inicializa a GLFW (janela, contexto, callbacks, etc)
     if (!glfwInit()) {   // Inicialização da GLFW
@@ -86,52 +117,107 @@ int main() {
 
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // Ajusta a viewport quando a janela é redimensionada
     glfwSetMouseButtonCallback(window, mouse_button_callback); // Captura eventos botão do mouse
+    glfwSetCursorPosCallback(window, cursor_position_callback); // Captura movimento do mouse (arrastar pontos)
     glfwSetKeyCallback(window, key_callback); // Captura eventos de teclado
+    glfwSetWindowRefreshCallback(window, window_refresh_callback); // Janela exposta: redesenha
+    glfwSetScrollCallback(window, scroll_callback); // Roda do mouse: zoom
 
     // GLAD: Inicializa e carrega todos os ponteiros de funções da OpenGL
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         cerr << "Falha ao inicializar GLAD" << endl;
         return EXIT_FAILURE;}
 
-    // Definindo as dimensões da viewport
-    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-
     // Configura cor de fundo
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 
-    // Cria programa de shader
-    shaderProgram = createShaderProgram();
+    // Sincronismo vertical; durante o arraste passa para o adaptativo, se houver
+    glfwSwapInterval(1);
+    vsyncAdaptativo = glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                      glfwExtensionSupported("GLX_EXT_swap_control_tear");
 
-    // Configura buffers
-    setupBuffers();
+    // A exportação em segundo plano acorda o loop principal para informar o progresso
+    exportador.definirAvisoDeProgresso([]() { glfwPostEmptyEvent(); });
+
+    // Cria shader e buffers e define a viewport e a projeção
+    int larguraFramebuffer, alturaFramebuffer;
+    glfwGetFramebufferSize(window, &larguraFramebuffer, &alturaFramebuffer);
+    if (!renderizador.inicializar(larguraFramebuffer, alturaFramebuffer)) {
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    camera.definirJanela(larguraFramebuffer, alturaFramebuffer);
+    renderizador.definirCamera(camera);
+
+    // Retoma o projeto salvo (pontos de controle e parâmetros), se houver
+    vector<vec2> pontosProjeto;
+    if (projeto.carregar(pontosProjeto, parametros)) {
+        trackEditor.definirPontosDeControle(pontosProjeto);
+        trackEditor.definirPontes(parametros.pontesAutomaticas, parametros.alturaPonte, parametros.comprimentoRampa);
+    }
+    renderizador.definirAvaliacaoNaGPU(parametros.avaliacaoNaGPU);
+    renderizador.definirParametrosGPU(parametros.pontosPorSegmento, parametros.larguraDaPista);
 
     // Instruções
     cout << "  CONTROLES  " << endl;
     cout << "  Clique Esquerdo: Adicionar ponto de controle" << endl;
+    cout << "  Arrastar ponto (Clique Esquerdo sobre ele): Mover ponto de controle" << endl;
     cout << "  Clique Direito: Remover ultimo ponto" << endl;
     cout << "  C: Limpar todos os pontos" << endl;
     cout << "  G: Gerar curva B-Spline" << endl;
+    cout << "  A: Alternar tesselacao fixa/adaptativa" << endl;
+    cout << "  N: Alternar o grau da curva (2 a 7; 3 = B-Spline cubica)" << endl;
     cout << "  T: Gerar pista (curvas interna/externa)" << endl;
-    cout << "  E: Triangularizar e Exportar para OBJ" << endl;
+    cout << "  F: Gerar curva, pista e malha em uma passada (caminho fundido)" << endl;
+    cout << "  D: Mostrar/esconder curva e bordas do caminho fundido" << endl;
+    cout << "  P: Ligar/desligar pontes automaticas nos cruzamentos" << endl;
+    cout << "  U: Ligar/desligar a avaliacao das curvas na GPU" << endl;
+    cout << "  S: Ligar/desligar amostras igualmente espacadas em track_curve.txt" << endl;
+    cout << "  E: Triangularizar e Exportar (OBJ, GLB, .trk, curva) em segundo plano" << endl;
+    cout << "  I: Importar a curva e a malha exportadas (track_curve.txt e track.obj)" << endl;
+    cout << "  Roda do mouse: Zoom / Botao do meio: Deslocar a vista / V: Enquadrar a pista" << endl;
+    cout << "  R: Iniciar/parar o rastreamento das etapas (grava " << TRACE_PATH << ")" << endl;
     cout << "  ESC: Sair" << endl;
     cout << endl;
 
-    // Loop principal
+    // Loop principal: só redesenha quando o editor mudou; no resto do tempo fica bloqueado
+    // esperando eventos, sem ocupar CPU nem GPU
     while (!glfwWindowShouldClose(window)) {
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        renderEditor();
+        if (renderizador.desatualizado(trackEditor)) agendador.marcar();
+
+        double agora = glfwGetTime();
+        if (agendador.redesenharAgora(agora)) {
+            PERFIL_ZONA("quadro");
+
+            // Os movimentos do arraste entre dois quadros viram uma única regeneração; com as
+            // curvas avaliadas na GPU o desenho não precisa dela, que fica para quando o ponto é solto
+            if (pontoArrastado < 0 || !renderizador.curvasNaGPU(trackEditor)) {
+                trackEditor.atualizarTrechosAlterados();
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT);
+            renderizador.desenhar(trackEditor);
+            {
+                PERFIL_ZONA("glfwSwapBuffers");
+                glfwSwapBuffers(window);
+            }
+            agendador.quadroDesenhado(agora);
+        }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        double espera = agendador.espera(glfwGetTime());
+        if (espera < 0.0) {
+            glfwWaitEvents();
+        } else if (espera > 0.0) {
+            glfwWaitEventsTimeout(espera);
+        } else {
+            glfwPollEvents();
+        }
+        exportador.atualizar();     // Progresso/conclusão da exportação em segundo plano
     }
+    exportador.aguardar();          // Não fecha com arquivos pela metade
+    if (!projetoDesanexado) projeto.salvar(trackEditor.obterPontosDeControle(), parametros);
 
     // Limpeza
-    glDeleteProgram(shaderProgram);
-    glDeleteVertexArrays(1, &pointsVAO);
-    glDeleteBuffers(1, &pointsVBO);
-    glDeleteVertexArrays(1, &linesVAO);
-    glDeleteBuffers(1, &linesVBO);
+    renderizador.finalizar();
 
     glfwTerminate();
     return 0;
@@ -139,7 +225,14 @@ int main() {
 
 
 // Captura de eventos e callbacks
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) { glViewport(0, 0, width, height); }
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glfwGetWindowSize(window, &larguraJanela, &alturaJanela);
+    renderizador.redimensionar(width, height);
+    camera.definirJanela(width, height);
+    renderizador.definirCamera(camera);
+}
+
+void window_refresh_callback(GLFWwindow* window) { agendador.marcar(); }
 
 
 // Captura de clique do mouse
@@ -150,280 +243,271 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
         
         if (button == GLFW_MOUSE_BUTTON_LEFT) {
             vec2 worldPos = screenToWorld(xpos, ypos);
-            trackEditor.adicionarPontoDeControle(worldPos); // Adiciona ponto de controle
+            
+            // Clique sobre um ponto existente inicia o arraste; caso contrário adiciona um novo
+            float raio = raioSelecaoPixels * camera.obterTamanhoPixel();
+            pontoArrastado = trackEditor.encontrarPontoDeControle(worldPos, raio);
+            if (pontoArrastado < 0) {
+                trackEditor.adicionarPontoDeControle(worldPos); // Adiciona ponto de controle
+                reanexarProjeto();
+                projeto.registrarAdicao(worldPos);
+            } else {
+                alocacoesInicioArraste = obterTotalDeAlocacoes();
+                if (vsyncAdaptativo) glfwSwapInterval(-1);  // Quadro atrasado não espera o próximo vsync
+            }
+            mousePressed = true;
+            lastMouseX = xpos;
+            lastMouseY = ypos;
         }
         else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
+            concluirArraste();      // O ponto arrastado pode ser o removido
             trackEditor.removerUltimoPontoDeControle(); // Remove último ponto de controle
+            reanexarProjeto();
+            projeto.registrarRemocao();
+        }
+        else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
+            deslocandoVista = true;
+            ancoraDeslocamento = screenToWorld(xpos, ypos);
         }
     }
+    else if (action == GLFW_RELEASE && button == GLFW_MOUSE_BUTTON_MIDDLE) {
+        deslocandoVista = false;
+    }
+    else if (action == GLFW_RELEASE && button == GLFW_MOUSE_BUTTON_LEFT) {
+        concluirArraste();
+    }
+    salvarProjetoSeNecessario();
+}
+
+
+// Termina o arraste em andamento (soltar o botão, ou antes de C, I e clique direito mudarem
+// os pontos de controle): regeneração pendente, pontes e a posição final no diário
+void concluirArraste() {
+    if (pontoArrastado >= 0) {
+        if (vsyncAdaptativo) glfwSwapInterval(1);
+        if (pontoArrastado < (int)trackEditor.obterPontosDeControle().size()) {
+            trackEditor.concluirEdicao();   // Último movimento, se ainda não desenhado, e pontes
+            // Em regime a edição não deve alocar (buffers mantêm a capacidade, rascunho vem da arena)
+            if (CONTAGEM_DE_ALOCACOES) {
+                cout << "Alocacoes no heap durante o arraste: " << obterTotalDeAlocacoes() - alocacoesInicioArraste << endl;
+            }
+            // Só a posição final do arraste vai para o diário
+            projeto.registrarMovimento(pontoArrastado, trackEditor.obterPontosDeControle()[pontoArrastado]);
+        }
+    }
+    mousePressed = false;
+    pontoArrastado = -1;
+}
+
+
+// Captura de movimento do mouse: arrasta o ponto selecionado e regenera só os trechos afetados
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
+    // Deslocamento da vista: o ponto do mundo sob o cursor no clique continua sob o cursor
+    if (deslocandoVista) {
+        camera.deslocar(ancoraDeslocamento - screenToWorld(xpos, ypos));
+        renderizador.definirCamera(camera);
+    }
+    
+    if (!mousePressed || pontoArrastado < 0) return;
+    if (xpos == lastMouseX && ypos == lastMouseY) return;
+    
+    lastMouseX = xpos;
+    lastMouseY = ypos;
+    
+    // Os trechos afetados são regenerados no próximo quadro (ver o loop principal)
+    trackEditor.moverPontoDeControle(pontoArrastado, screenToWorld(xpos, ypos));
+}
+
+
+// Roda do mouse: zoom em torno do ponto sob o cursor
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    
+    camera.aplicarZoom(pow(1.2f, float(yoffset)), screenToWorld(xpos, ypos));
+    renderizador.definirCamera(camera);
 }
 
 
 // Captura de teclado
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action == GLFW_PRESS) {
+        trackEditor.atualizarTrechosAlterados();    // Movimento do arraste ainda não desenhado
+        
         switch (key) {
             case GLFW_KEY_ESCAPE:
                 glfwSetWindowShouldClose(window, true); // Fecha a janela
                 break;
                 
+            case GLFW_KEY_V:    // Ajusta a vista à pista inteira
+                enquadrarPista();
+                break;
+                
             case GLFW_KEY_C:    // Limpa todos os pontos de controle
+                concluirArraste();
                 trackEditor.limparPontosDeControle();   
+                projetoDesanexado = false;  // Recomeça o projeto vazio
+                projeto.registrarLimpeza();
                 break;
                 
             case GLFW_KEY_G:    // Gera curva B-Spline
                 if (trackEditor.obterPontosDeControle().size() >= 4) {  // Mínimo 4 pontos para B-Spline
-                    trackEditor.gerarBSpline(pontosPorSegmento);        // quantidade de pontos por segmento
+                    if (parametros.tesselacaoAdaptativa) {
+                        trackEditor.gerarBSplineAdaptativa(parametros.toleranciaCorda, parametros.toleranciaAngulo);
+                    } else {
+                        trackEditor.gerarBSplineDeGrau(parametros.grauCurva, parametros.pontosPorSegmento);    // quantidade de pontos por segmento
+                    }
                 } else {
                     cout << "Necessário pelo menos 4 pontos de controle!" << endl;
                 }
                 break;
                 
+            case GLFW_KEY_A:    // Alterna entre tesselação fixa e adaptativa (vale na próxima geração)
+                parametros.tesselacaoAdaptativa = !parametros.tesselacaoAdaptativa;
+                projeto.registrarParametros(parametros);
+                cout << "Tesselacao " << (parametros.tesselacaoAdaptativa ? "adaptativa" : "fixa") << " selecionada" << endl;
+                break;
+                
+            case GLFW_KEY_N:    // Próximo grau da curva, de 2 a 7 (vale na próxima geração com tesselação fixa)
+                parametros.grauCurva = (parametros.grauCurva < NURBS_GRAU_MAXIMO) ? parametros.grauCurva + 1 : 2;
+                projeto.registrarParametros(parametros);
+                cout << "Curva de grau " << parametros.grauCurva << " selecionada";
+                if (parametros.tesselacaoAdaptativa) cout << " (vale na tesselacao fixa)";
+                cout << endl;
+                break;
+                
             case GLFW_KEY_T:    // Calcula curvas interna e externa
                 if (trackEditor.obterPontosBSpline().size() > 0) {  // Verifica se a curva B-Spline foi gerada
-                    trackEditor.calcularCurvasInternaExterna(larguraDaPista);   
+                    trackEditor.calcularCurvasInternaExterna(parametros.larguraDaPista);   
                 } else {
                     cout << "Gere a curva B-Spline primeiro (tecla G)!" << endl;
                 }
                 break;
                 
+            case GLFW_KEY_F:    // Curva, bordas e malha em uma única passada
+                if (trackEditor.obterPontosDeControle().size() >= 4) {
+                    trackEditor.gerarPistaFundida(parametros.pontosPorSegmento, parametros.larguraDaPista);
+                    if (curvasDeDepuracao) trackEditor.preencherCurvasDeDepuracao();
+                } else {
+                    cout << "Necessário pelo menos 4 pontos de controle!" << endl;
+                }
+                break;
+                
+            case GLFW_KEY_D:    // Curva e bordas do caminho fundido no editor (só a malha, desligado)
+                curvasDeDepuracao = !curvasDeDepuracao;
+                if (curvasDeDepuracao) trackEditor.preencherCurvasDeDepuracao();
+                cout << "Curva e bordas do caminho fundido " << (curvasDeDepuracao ? "visiveis" : "escondidas") << endl;
+                break;
+                
+            case GLFW_KEY_P:    // Alterna pontes automáticas nos cruzamentos (vale na malha atual e nas próximas)
+                parametros.pontesAutomaticas = !parametros.pontesAutomaticas;
+                projeto.registrarParametros(parametros);
+                trackEditor.definirPontes(parametros.pontesAutomaticas, parametros.alturaPonte, parametros.comprimentoRampa);
+                cout << "Pontes automaticas " << (parametros.pontesAutomaticas ? "ligadas" : "desligadas") << endl;
+                break;
+                
+            case GLFW_KEY_U:    // Alterna a avaliação da curva e das bordas no vertex shader
+                parametros.avaliacaoNaGPU = !parametros.avaliacaoNaGPU;
+                projeto.registrarParametros(parametros);
+                renderizador.definirAvaliacaoNaGPU(parametros.avaliacaoNaGPU);
+                cout << "Avaliacao das curvas na GPU " << (parametros.avaliacaoNaGPU ? "ligada" : "desligada");
+                if (parametros.avaliacaoNaGPU && !trackEditor.curvaUniforme()) {
+                    cout << " (vale para a B-Spline cubica gerada com G em tesselacao fixa)";
+                }
+                cout << endl;
+                break;
+                
+            case GLFW_KEY_R:    // Liga o rastreamento; na segunda vez desliga e grava o que foi registrado
+                if (!Perfilador::ativo()) {
+                    Perfilador::ativar(true);
+                    cout << "Rastreamento iniciado (R para parar e gravar)" << endl;
+                } else {
+                    Perfilador::ativar(false);
+                    Perfilador::gravarRastreamento(TRACE_PATH);
+                }
+                break;
+                
+            case GLFW_KEY_S:    // Alterna track_curve.txt entre as amostras da curva e a reamostragem por comprimento de arco
+                parametros.espacamentoCurvaAnimacao = (parametros.espacamentoCurvaAnimacao > 0.0f) ? 0.0f : ESPACAMENTO_CURVA_ANIMACAO;
+                projeto.registrarParametros(parametros);
+                if (parametros.espacamentoCurvaAnimacao > 0.0f) {
+                    cout << "Curva de animacao com amostras a cada " << parametros.espacamentoCurvaAnimacao << " unidades" << endl;
+                } else {
+                    cout << "Curva de animacao com as amostras da B-Spline" << endl;
+                }
+                break;
+                
             case GLFW_KEY_E:    // Triangulariza, calcula normais e exporta arquivos
+                trackEditor.preencherCurvasDeDepuracao();   // Depois do caminho fundido a exportação usa curva e bordas
                 if (trackEditor.obterCurvaInterna().size() > 0 && trackEditor.obterCurvaExterna().size() > 0) { // Verifica se as curvas foram geradas
+                    if (exportador.emAndamento()) {
+                        cout << "Aguarde a exportacao anterior terminar" << endl;
+                        break;
+                    }
                     trackEditor.triangularizarMalha();
                     trackEditor.calcularNormais();      
-                    trackEditor.exportarOBJ(OUTPUT_PATH);
-                    trackEditor.exportarCurvaAnimacao(OUTPUT_PATH);
-                    cout << "Pista exportada com sucesso!" << endl;
+                    // Copia a malha e grava os arquivos em segundo plano; a edição continua
+                    exportador.iniciar(trackEditor, OUTPUT_PATH, parametros.espacamentoCurvaAnimacao);
                 } else {
                     cout << "Gere as curvas da pista primeiro (tecla T)!" << endl;
                 }
                 break;
+                
+            case GLFW_KEY_I:    // Importa os arquivos exportados no lugar da pista atual
+                if (exportador.emAndamento()) {
+                    cout << "Aguarde a exportacao terminar antes de importar" << endl;
+                    break;
+                }
+                concluirArraste();
+                // A curva primeiro: importar a curva descarta a malha atual
+                if (trackEditor.importarCurvaAnimacao(OUTPUT_PATH + "track_curve.txt")) {
+                    trackEditor.importarOBJ(OUTPUT_PATH + "track.obj");
+                    // A curva importada não tem pontos de controle: o projeto salvo continua
+                    // como estava até a próxima edição dos pontos
+                    projetoDesanexado = true;
+                    cout << "Projeto " << PROJECT_PATH << " mantido; a proxima edicao dos pontos recomeca o projeto" << endl;
+                }
+                break;
         }
     }
+    salvarProjetoSeNecessario();
 }
 
 
-// Converte coordenadas de tela para a visao do mundo (world coordinates)
-vec2 screenToWorld(double xpos, double ypos) {
-    // Converte coordenadas de tela para mundo (NDC ajustado para aspect ratio) - NDC (Normalized Device Coordinates)
-    float x = (xpos / SCREEN_WIDTH) * 2.0f - 1.0f;
-    float y = 1.0f - (ypos / SCREEN_HEIGHT) * 2.0f;
-    
-    // Ajusta para aspect ratio
-    float aspect = (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT;
-    x *= aspect;
-    
-    return vec2(x * 5.0f, y * 5.0f);  // Escala o mundo para ±5 unidades
+// Compacta o diário do projeto quando ele fica maior que o próprio projeto
+void salvarProjetoSeNecessario() {
+    if (!projetoDesanexado && projeto.diarioLongo(trackEditor.obterPontosDeControle().size())) {
+        projeto.salvar(trackEditor.obterPontosDeControle(), parametros);
+    }
 }
 
 
-// Configura buffers de OpenGL
-void setupBuffers() {
-    // VAO e VBO para pontos
-    glGenVertexArrays(1, &pointsVAO);
-    glGenBuffers(1, &pointsVBO);
-    
-    glBindVertexArray(pointsVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, pointsVBO);
-    
-    // Posição
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Cor
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // VAO e VBO para linhas
-    glGenVertexArrays(1, &linesVAO);
-    glGenBuffers(1, &linesVBO);
-    
-    glBindVertexArray(linesVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, linesVBO);
-    
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    glBindVertexArray(0);
+// Primeira edição dos pontos depois de importar: o projeto recomeça vazio (a curva importada
+// não tem pontos de controle) e volta a ser salvo
+void reanexarProjeto() {
+    if (!projetoDesanexado) return;
+    projeto.registrarLimpeza();
+    projetoDesanexado = false;
 }
 
 
-// Renderiza o editor de pista
-void renderEditor() {
-    glUseProgram(shaderProgram);
-    
-    // Matriz de projeção ortográfica
-    float aspect = (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT;
-    mat4 projection = ortho(-5.0f * aspect, 5.0f * aspect, -5.0f, 5.0f, -1.0f, 1.0f);
-    
-    // Define uniform da matriz de projeção
-    GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, value_ptr(projection));
-    
-    // Renderiza pontos de controle (vermelho)
-    const auto& pontosDeControle = trackEditor.obterPontosDeControle();
-    if (!pontosDeControle.empty()) {
-        vector<float> pointData;
-        for (const auto& p : pontosDeControle) {
-            pointData.push_back(p.x);
-            pointData.push_back(p.y);
-            pointData.push_back(1.0f);  // Vermelho
-            pointData.push_back(0.0f);
-            pointData.push_back(0.0f);
-        }
-        
-        glBindVertexArray(pointsVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, pointsVBO);
-        glBufferData(GL_ARRAY_BUFFER, pointData.size() * sizeof(float), 
-                     pointData.data(), GL_DYNAMIC_DRAW);
-        
-        glPointSize(10.0f);
-        glDrawArrays(GL_POINTS, 0, pontosDeControle.size());
-    }
-    
-    // Renderiza curva B-Spline (verde)
-    const auto& bSplinePoints = trackEditor.obterPontosBSpline();
-    if (!bSplinePoints.empty()) {
-        vector<float> lineData;
-        for (const auto& p : bSplinePoints) {
-            lineData.push_back(p.x);
-            lineData.push_back(p.y);
-            lineData.push_back(0.0f);  // Verde
-            lineData.push_back(1.0f);
-            lineData.push_back(0.0f);
-        }
-        
-        glBindVertexArray(linesVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, linesVBO);
-        glBufferData(GL_ARRAY_BUFFER, lineData.size() * sizeof(float), 
-                     lineData.data(), GL_DYNAMIC_DRAW);
-        
-        glLineWidth(2.0f);
-        glDrawArrays(GL_LINE_LOOP, 0, bSplinePoints.size());
-    }
-    
-    // Renderiza curvas interna e externa (azul e amarelo)
-    const auto& innerCurve = trackEditor.obterCurvaInterna();
-    const auto& outerCurve = trackEditor.obterCurvaExterna();
-    
-    if (!innerCurve.empty()) {
-        vector<float> innerData;
-        for (const auto& p : innerCurve) {
-            innerData.push_back(p.x);
-            innerData.push_back(p.y);
-            innerData.push_back(0.0f);  // Azul
-            innerData.push_back(0.0f);
-            innerData.push_back(1.0f);
-        }
-        
-        glBindVertexArray(linesVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, linesVBO);
-        glBufferData(GL_ARRAY_BUFFER, innerData.size() * sizeof(float), 
-                     innerData.data(), GL_DYNAMIC_DRAW);
-        
-        glLineWidth(2.0f);
-        glDrawArrays(GL_LINE_LOOP, 0, innerCurve.size());
-    }
-    
-    if (!outerCurve.empty()) {
-        vector<float> outerData;
-        for (const auto& p : outerCurve) {
-            outerData.push_back(p.x);
-            outerData.push_back(p.y);
-            outerData.push_back(1.0f);  // Amarelo
-            outerData.push_back(1.0f);
-            outerData.push_back(0.0f);
+// Ajusta a câmera para mostrar os pontos de controle e as curvas inteiras
+void enquadrarPista() {
+    vec2 minimo(INFINITY), maximo(-INFINITY);
+    for (const vector<vec2>* pontos : { &trackEditor.obterPontosDeControle(), &trackEditor.obterPontosBSpline(),
+                                        &trackEditor.obterCurvaInterna(), &trackEditor.obterCurvaExterna() }) {
+        for (const vec2& p : *pontos) {
+            minimo = min(minimo, p);
+            maximo = max(maximo, p);
         }
-        
-        glBindVertexArray(linesVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, linesVBO);
-        glBufferData(GL_ARRAY_BUFFER, outerData.size() * sizeof(float), 
-                     outerData.data(), GL_DYNAMIC_DRAW);
-        
-        glLineWidth(2.0f);
-        glDrawArrays(GL_LINE_LOOP, 0, outerCurve.size());
     }
-    
-    glBindVertexArray(0);
+    camera.enquadrar(minimo, maximo);
+    renderizador.definirCamera(camera);
 }
 
 
-// Função para criar o programa de shader
-GLuint createShaderProgram() {
-    // Código fonte do vertex shader
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout (location = 0) in vec2 aPos;
-        layout (location = 1) in vec3 aColor;
-        
-        out vec3 vertexColor;
-        
-        uniform mat4 projection;
-        
-        void main()
-        {
-            gl_Position = projection * vec4(aPos, 0.0, 1.0);
-            vertexColor = aColor;
-        }
-    )";
-    
-    // Código fonte do fragment shader
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        in vec3 vertexColor;
-        out vec4 FragColor;
-        
-        void main()
-        {
-            FragColor = vec4(vertexColor, 1.0);
-        }
-    )";
-    
-    // Compila vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    
-    // Verifica erros de compilação do vertex shader
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        cerr << "ERRO::VERTEX_SHADER::COMPILACAO_FALHOU\n" << infoLog << endl;
-    }
-    
-    // Compila fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    
-    // Verifica erros de compilação do fragment shader
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        cerr << "ERRO::FRAGMENT_SHADER::COMPILACAO_FALHOU\n" << infoLog << endl;
-    }
-    
-    // Cria programa de shader e linka os shaders
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-    
-    // Verifica erros de linkagem
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
-        cerr << "ERRO::PROGRAM::LINKAGEM_FALHOU\n" << infoLog << endl;
-    }
-    
-    // Deleta os shaders (já foram linkados ao programa)
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    return program;
-}
\ No newline at end of file
+// Converte coordenadas de tela para a visao do mundo (world coordinates)
+vec2 screenToWorld(double xpos, double ypos) {
+    // Posição do cursor na janela -> mundo, conforme o zoom e o deslocamento da câmera
+    return camera.telaParaMundo(xpos, ypos, larguraJanela, alturaJanela);
+}
@@ -0,0 +1,16 @@
+#include "AgendadorQuadros.h"
+
+void AgendadorQuadros::definirLimite(double quadrosPorSegundo) {
+    intervaloMinimo = quadrosPorSegundo > 0.0 ? 1.0 / quadrosPorSegundo : 0.0;
+}
+
+void AgendadorQuadros::quadroDesenhado(double agora) {
+    pendente = false;
+    proximoQuadro = agora + intervaloMinimo;
+    quadrosDesenhados++;
+}
+
+double AgendadorQuadros::espera(double agora) const {
+    if (!pendente) return -1.0;
+    return proximoQuadro > agora ? proximoQuadro - agora : 0.0;
+}
@@ -0,0 +1,31 @@
+#include "ArenaRascunho.h"
+
+// Bloco inicial; cresce sob demanda até o pico de uso das gerações
+static const size_t TAMANHO_INICIAL_ARENA = size_t(1) << 20;
+
+ArenaRascunho::ArenaRascunho() {
+    tamanhoBloco = TAMANHO_INICIAL_ARENA;
+    bloco.reset(new byte[tamanhoBloco]);
+    monotonico.emplace(bloco.get(), tamanhoBloco, &excedente);
+}
+
+void ArenaRascunho::reiniciar() {
+    // Devolve ao heap os blocos excedentes antes de (talvez) trocar o bloco principal
+    monotonico.reset();
+
+    if (excedente.bytes > 0) {
+        tamanhoBloco += excedente.bytes;
+        bloco.reset(new byte[tamanhoBloco]);
+        excedente.bytes = 0;
+    }
+    monotonico.emplace(bloco.get(), tamanhoBloco, &excedente);
+}
+
+void* ArenaRascunho::Excedente::do_allocate(size_t tamanho, size_t alinhamento) {
+    bytes += tamanho;
+    return pmr::new_delete_resource()->allocate(tamanho, alinhamento);
+}
+
+void ArenaRascunho::Excedente::do_deallocate(void* p, size_t tamanho, size_t alinhamento) {
+    pmr::new_delete_resource()->deallocate(p, tamanho, alinhamento);
+}
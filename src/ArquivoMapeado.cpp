@@ -0,0 +1,85 @@
+#include "ArquivoMapeado.h"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ArquivoMapeado::~ArquivoMapeado() {
+    fechar();
+}
+
+bool ArquivoMapeado::abrir(const string& caminho) {
+    fechar();
+
+#ifdef _WIN32
+    HANDLE hArquivo = CreateFileA(caminho.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hArquivo == INVALID_HANDLE_VALUE) {
+        cout << "Erro ao abrir arquivo: " << caminho << endl;
+        return false;
+    }
+    LARGE_INTEGER tamanhoArquivo;
+    if (!GetFileSizeEx(hArquivo, &tamanhoArquivo) || tamanhoArquivo.QuadPart == 0) {
+        cout << "Arquivo vazio: " << caminho << endl;
+        CloseHandle(hArquivo);
+        return false;
+    }
+    HANDLE hMapeamento = CreateFileMappingA(hArquivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* vista = hMapeamento ? MapViewOfFile(hMapeamento, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!vista) {
+        cout << "Erro ao mapear arquivo: " << caminho << endl;
+        if (hMapeamento) CloseHandle(hMapeamento);
+        CloseHandle(hArquivo);
+        return false;
+    }
+    arquivo = hArquivo;
+    mapeamento = hMapeamento;
+    bytes = size_t(tamanhoArquivo.QuadPart);
+    base = static_cast<const unsigned char*>(vista);
+#else
+    int descritor = open(caminho.c_str(), O_RDONLY);
+    if (descritor < 0) {
+        cout << "Erro ao abrir arquivo: " << caminho << endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(descritor, &info) != 0 || info.st_size == 0) {
+        cout << "Arquivo vazio: " << caminho << endl;
+        close(descritor);
+        return false;
+    }
+    void* vista = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, descritor, 0);
+    close(descritor);   // O mapeamento continua válido sem o descritor
+    if (vista == MAP_FAILED) {
+        cout << "Erro ao mapear arquivo: " << caminho << endl;
+        return false;
+    }
+    bytes = size_t(info.st_size);
+    base = static_cast<const unsigned char*>(vista);
+#endif
+    return true;
+}
+
+void ArquivoMapeado::fechar() {
+    if (!base) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mapeamento));
+    CloseHandle(static_cast<HANDLE>(arquivo));
+    mapeamento = nullptr;
+    arquivo = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(base), bytes);
+#endif
+    base = nullptr;
+    bytes = 0;
+}
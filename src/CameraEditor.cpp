@@ -0,0 +1,52 @@
+#include "CameraEditor.h"
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Limites da meia altura: abaixo disso a precisão do float some, acima não há pista
+const float MEIA_ALTURA_MINIMA = 1e-3f;
+const float MEIA_ALTURA_MAXIMA = 1e7f;
+
+void CameraEditor::definirJanela(int novaLargura, int novaAltura) {
+    if (novaLargura <= 0 || novaAltura <= 0) return;     // Janela minimizada
+    largura = novaLargura;
+    altura = novaAltura;
+}
+
+vec2 CameraEditor::telaParaMundo(double x, double y, int larguraTela, int alturaTela) const {
+    // Coordenadas normalizadas (-1 a 1, y para cima) e depois escala e centro da vista
+    float nx = float(x / larguraTela) * 2.0f - 1.0f;
+    float ny = 1.0f - float(y / alturaTela) * 2.0f;
+    return centro + vec2(nx * meiaAltura * proporcao(), ny * meiaAltura);
+}
+
+void CameraEditor::aplicarZoom(float fator, vec2 ancora) {
+    if (fator <= 0.0f) return;
+    float novaMeiaAltura = std::clamp(meiaAltura / fator, MEIA_ALTURA_MINIMA, MEIA_ALTURA_MAXIMA);
+
+    // A âncora fica parada: a distância dela ao centro escala junto com a vista
+    centro = ancora + (centro - ancora) * (novaMeiaAltura / meiaAltura);
+    meiaAltura = novaMeiaAltura;
+}
+
+void CameraEditor::enquadrar(vec2 minimo, vec2 maximo) {
+    if (minimo.x > maximo.x || minimo.y > maximo.y) return;     // Caixa vazia
+
+    centro = (minimo + maximo) * 0.5f;
+    vec2 meiaCaixa = (maximo - minimo) * 0.5f * 1.1f;           // 10% de margem
+    float necessaria = std::max(meiaCaixa.y, meiaCaixa.x / proporcao());
+    meiaAltura = std::clamp(necessaria, MEIA_ALTURA_MINIMA, MEIA_ALTURA_MAXIMA);
+}
+
+mat4 CameraEditor::obterProjecao() const {
+    vec2 minimo = obterMinimoVisivel();
+    vec2 maximo = obterMaximoVisivel();
+    return ortho(minimo.x, maximo.x, minimo.y, maximo.y, -1.0f, 1.0f);
+}
+
+vec2 CameraEditor::obterMinimoVisivel() const {
+    return centro - vec2(meiaAltura * proporcao(), meiaAltura);
+}
+
+vec2 CameraEditor::obterMaximoVisivel() const {
+    return centro + vec2(meiaAltura * proporcao(), meiaAltura);
+}
@@ -0,0 +1,63 @@
+#include "ContadorAlocacoes.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+static std::atomic<size_t> totalDeAlocacoes{0};
+
+size_t obterTotalDeAlocacoes() {
+    return totalDeAlocacoes.load(std::memory_order_relaxed);
+}
+
+#ifdef TRACK_CONTAR_ALOCACOES
+
+// Como o operator new da biblioteca: sem memória, chama o new_handler instalado (que pode
+// liberar memória) e tenta de novo; sem handler, bad_alloc
+static void* alocarOuTratar(std::size_t tamanho) {
+    while (true) {
+        if (void* p = std::malloc(tamanho)) return p;
+        std::new_handler tratador = std::get_new_handler();
+        if (!tratador) throw std::bad_alloc();
+        tratador();
+    }
+}
+
+// Substitui o operator new/delete global: conta e repassa ao malloc/free.
+// As demais formas (array, nothrow, sem tamanho no delete) da biblioteca padrão
+// chamam estas, então todas as alocações passam pelo contador.
+void* operator new(std::size_t tamanho) {
+    totalDeAlocacoes.fetch_add(1, std::memory_order_relaxed);
+    if (tamanho == 0) tamanho = 1;
+    return alocarOuTratar(tamanho);
+}
+
+// Alinhadas: reserva folga no malloc e guarda o ponteiro original logo antes do bloco
+// (aligned_alloc não existe em todas as bibliotecas C, ex.: MinGW)
+void* operator new(std::size_t tamanho, std::align_val_t alinhamento) {
+    totalDeAlocacoes.fetch_add(1, std::memory_order_relaxed);
+    size_t a = static_cast<size_t>(alinhamento);
+    void* bruto = alocarOuTratar(tamanho + a + sizeof(void*));
+    
+    uintptr_t inicio = (uintptr_t(bruto) + sizeof(void*) + a - 1) & ~(uintptr_t(a) - 1);
+    reinterpret_cast<void**>(inicio)[-1] = bruto;
+    return reinterpret_cast<void*>(inicio);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    if (p) std::free(static_cast<void**>(p)[-1]);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alinhamento) noexcept {
+    operator delete(p, alinhamento);
+}
+
+#endif
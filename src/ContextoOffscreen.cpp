@@ -0,0 +1,123 @@
+#include "ContextoOffscreen.h"
+#include <iostream>
+#include <cstring>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+// Display EGL sem janela: plataforma surfaceless da Mesa quando existe, senão o padrão
+static EGLDisplay abrirDisplay() {
+    const char* extensoes = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensoes && strstr(extensoes, "EGL_MESA_platform_surfaceless")) {
+        auto obterDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (obterDisplay) {
+            EGLDisplay d = obterDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (d != EGL_NO_DISPLAY) return d;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool ContextoOffscreen::criar(int novaLargura, int novaAltura) {
+    destruir();
+    if (novaLargura <= 0 || novaAltura <= 0) {
+        cout << "Tamanho invalido para o contexto offscreen: " << novaLargura << "x" << novaAltura << endl;
+        return false;
+    }
+
+    EGLDisplay d = abrirDisplay();
+    if (d == EGL_NO_DISPLAY || !eglInitialize(d, nullptr, nullptr)) {
+        cout << "Falha ao inicializar EGL" << endl;
+        return false;
+    }
+    display = d;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        cout << "EGL sem suporte a OpenGL (desktop)" << endl;
+        destruir();
+        return false;
+    }
+
+    // Sem superfície: o contexto só precisa de uma configuração com OpenGL
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    const EGLint atributosConfig[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    eglChooseConfig(d, atributosConfig, &config, 1, &numConfigs);
+
+    const EGLint atributosContexto[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext c = eglCreateContext(d, numConfigs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, atributosContexto);
+    if (c == EGL_NO_CONTEXT) {
+        cout << "Falha ao criar contexto OpenGL 3.3 pela EGL" << endl;
+        destruir();
+        return false;
+    }
+    contexto = c;
+    if (!eglMakeCurrent(d, EGL_NO_SURFACE, EGL_NO_SURFACE, c)) {
+        cout << "Contexto EGL sem superficie nao suportado (EGL_KHR_surfaceless_context)" << endl;
+        destruir();
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        cout << "Falha ao inicializar GLAD" << endl;
+        destruir();
+        return false;
+    }
+
+    // FBO com um renderbuffer de cor no lugar da janela
+    largura = novaLargura;
+    altura = novaAltura;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &cor);
+    glBindRenderbuffer(GL_RENDERBUFFER, cor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, largura, altura);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, cor);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        cout << "FBO offscreen incompleto" << endl;
+        destruir();
+        return false;
+    }
+    glViewport(0, 0, largura, altura);
+    return true;
+}
+
+void ContextoOffscreen::destruir() {
+    if (contexto) {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (cor) glDeleteRenderbuffers(1, &cor);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, contexto);
+    }
+    if (display) eglTerminate(display);
+    display = contexto = nullptr;
+    fbo = cor = 0;
+    largura = altura = 0;
+}
+
+void ContextoOffscreen::lerPixels(vector<uint8_t>& rgba) const {
+    size_t bytesLinha = size_t(largura) * 4;
+    rgba.resize(bytesLinha * altura);
+    if (rgba.empty()) return;
+
+    // glReadPixels entrega a linha de baixo primeiro: inverte para o topo primeiro
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, largura, altura, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    vector<uint8_t> linha(bytesLinha);
+    for (int y = 0; y < altura / 2; y++) {
+        uint8_t* cima = &rgba[y * bytesLinha];
+        uint8_t* baixo = &rgba[(altura - 1 - y) * bytesLinha];
+        memcpy(linha.data(), cima, bytesLinha);
+        memcpy(cima, baixo, bytesLinha);
+        memcpy(baixo, linha.data(), bytesLinha);
+    }
+}
+
+string ContextoOffscreen::obterRenderizador() const {
+    const GLubyte* nome = contexto ? glGetString(GL_RENDERER) : nullptr;
+    return nome ? string(reinterpret_cast<const char*>(nome)) : string();
+}
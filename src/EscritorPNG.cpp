@@ -0,0 +1,107 @@
+#include "EscritorPNG.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+// Maior bloco deflate sem compressão (LEN de 16 bits)
+const size_t TAMANHO_BLOCO_DEFLATE = 65535;
+
+// CRC-32 dos chunks (polinômio 0xEDB88320, o mesmo do zlib), por tabela
+static uint32_t crc32(const uint8_t* dados, size_t n, uint32_t crc = 0) {
+    static uint32_t tabela[256];
+    static bool tabelaPronta = false;
+    if (!tabelaPronta) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            tabela[i] = c;
+        }
+        tabelaPronta = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = tabela[(crc ^ dados[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void escreverU32(vector<uint8_t>& saida, uint32_t v) {
+    saida.push_back(uint8_t(v >> 24));
+    saida.push_back(uint8_t(v >> 16));
+    saida.push_back(uint8_t(v >> 8));
+    saida.push_back(uint8_t(v));
+}
+
+// Chunk = tamanho | tipo | dados | CRC (do tipo e dos dados)
+static void escreverChunk(vector<uint8_t>& saida, const char tipo[4], const vector<uint8_t>& dados) {
+    escreverU32(saida, uint32_t(dados.size()));
+    size_t inicio = saida.size();
+    saida.insert(saida.end(), tipo, tipo + 4);
+    saida.insert(saida.end(), dados.begin(), dados.end());
+    escreverU32(saida, crc32(&saida[inicio], saida.size() - inicio));
+}
+
+bool gravarPNG(const string& caminho, int largura, int altura, const vector<uint8_t>& rgba) {
+    if (largura <= 0 || altura <= 0 || rgba.size() != size_t(largura) * altura * 4) {
+        cout << "Imagem invalida para PNG: " << caminho << endl;
+        return false;
+    }
+
+    // Linhas precedidas do tipo de filtro (0 = nenhum)
+    size_t bytesLinha = size_t(largura) * 4;
+    vector<uint8_t> linhas;
+    linhas.reserve((bytesLinha + 1) * altura);
+    for (int y = 0; y < altura; y++) {
+        linhas.push_back(0);
+        const uint8_t* linha = &rgba[y * bytesLinha];
+        linhas.insert(linhas.end(), linha, linha + bytesLinha);
+    }
+
+    // Fluxo zlib: cabeçalho, blocos deflate sem compressão e Adler-32 dos dados
+    vector<uint8_t> zlib;
+    size_t numBlocos = std::max<size_t>(1, (linhas.size() + TAMANHO_BLOCO_DEFLATE - 1) / TAMANHO_BLOCO_DEFLATE);
+    zlib.reserve(linhas.size() + numBlocos * 5 + 6);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    for (size_t inicio = 0; inicio < linhas.size(); inicio += TAMANHO_BLOCO_DEFLATE) {
+        size_t n = std::min(TAMANHO_BLOCO_DEFLATE, linhas.size() - inicio);
+        bool ultimo = inicio + n == linhas.size();
+        zlib.push_back(ultimo ? 1 : 0);
+        zlib.push_back(uint8_t(n));
+        zlib.push_back(uint8_t(n >> 8));
+        zlib.push_back(uint8_t(~n));
+        zlib.push_back(uint8_t(~n >> 8));
+        zlib.insert(zlib.end(), linhas.begin() + inicio, linhas.begin() + inicio + n);
+        for (size_t i = inicio; i < inicio + n; i++) {
+            a = (a + linhas[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    escreverU32(zlib, (b << 16) | a);
+
+    // IHDR: dimensões, 8 bits por canal, RGBA (tipo 6), sem entrelaçamento
+    vector<uint8_t> ihdr;
+    escreverU32(ihdr, uint32_t(largura));
+    escreverU32(ihdr, uint32_t(altura));
+    const uint8_t formato[5] = { 8, 6, 0, 0, 0 };
+    ihdr.insert(ihdr.end(), formato, formato + 5);
+
+    const uint8_t assinatura[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    vector<uint8_t> png(assinatura, assinatura + 8);
+    png.reserve(zlib.size() + 64);
+    escreverChunk(png, "IHDR", ihdr);
+    escreverChunk(png, "IDAT", zlib);
+    escreverChunk(png, "IEND", {});
+
+    ofstream file(caminho, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cout << "Erro ao abrir arquivo: " << caminho << endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), png.size());
+    if (!file) {
+        cout << "Erro ao gravar arquivo: " << caminho << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#include "EscritorTexto.h"
+#include <algorithm>
+
+EscritorTexto::EscritorTexto(ofstream& arquivo, size_t tamanhoBuffer)
+    : arquivo(&arquivo), buffer(tamanhoBuffer < 64 ? 64 : tamanhoBuffer) { }
+
+EscritorTexto::EscritorTexto(size_t capacidadeInicial)
+    : buffer(capacidadeInicial < 64 ? 64 : capacidadeInicial) { }
+
+// Descarrega o restante ao sair de escopo
+EscritorTexto::~EscritorTexto() {
+    descarregar();
+}
+
+void EscritorTexto::descarregar() {
+    if (arquivo && usado > 0) {
+        arquivo->write(buffer.data(), usado);
+        usado = 0;
+    }
+}
+
+// Buffer cheio: vai para o arquivo ou, no modo em memória, dobra de tamanho
+void EscritorTexto::abrirEspaco(size_t n) {
+    descarregar();
+    if (usado + n > buffer.size()) {
+        buffer.resize(std::max(buffer.size() * 2, usado + n));
+    }
+}
@@ -0,0 +1,86 @@
+#include "ExportadorAssincrono.h"
+#include "Perfilador.h"
+#include <iostream>
+
+ExportadorAssincrono::~ExportadorAssincrono() {
+    if (trabalhador.joinable()) trabalhador.join();
+}
+
+bool ExportadorAssincrono::iniciar(TrackEditor& editor, const string& caminho, float espacamentoCurva) {
+    if (emAndamento()) {
+        cout << "Exportacao anterior ainda em andamento (" << arquivosConcluidos << "/" << TOTAL_ARQUIVOS
+             << " arquivos)" << endl;
+        return false;
+    }
+    if (trabalhador.joinable()) trabalhador.join();
+
+    // Cópia na thread principal: a partir daqui o editor pode mudar à vontade
+    editor.capturarInstantaneo(instantaneo, espacamentoCurva);
+
+    arquivosConcluidos = 0;
+    falhas = 0;
+    terminou = false;
+    progressoInformado = 0;
+    inicio = chrono::steady_clock::now();
+
+    trabalhador = thread(&ExportadorAssincrono::executar, this, caminho, espacamentoCurva);
+    cout << "Exportando em segundo plano (" << instantaneo.vertices.size() << " vertices)..." << endl;
+    return true;
+}
+
+void ExportadorAssincrono::executar(string caminho, float espacamentoCurva) {
+    const InstantaneoPista& dados = instantaneo;
+    Perfilador::nomearThread("exportacao");
+    PERFIL_ZONA("exportacao");
+
+    // A curva é gravada em paralelo com os arquivos da malha
+    thread curva([&]() {
+        Perfilador::nomearThread("exportacao curva");
+        registrar(TrackEditor::exportarCurvaAnimacao(dados.pontosCurva, dados.alturasAmostras,
+                                                     dados.comprimentoAcumulado, caminho, espacamentoCurva));
+    });
+
+    registrar(TrackEditor::exportarOBJ(dados.vertices, dados.triangles, caminho));
+    registrar(TrackEditor::exportarTRK(dados.vertices, dados.triangles, caminho));
+    registrar(TrackEditor::exportarGLB(dados.vertices, dados.triangles, caminho));
+
+    curva.join();
+    terminou = true;
+    if (avisoDeProgresso) avisoDeProgresso();
+}
+
+void ExportadorAssincrono::registrar(bool sucesso) {
+    if (!sucesso) falhas++;
+    arquivosConcluidos++;
+    if (avisoDeProgresso) avisoDeProgresso();
+}
+
+void ExportadorAssincrono::atualizar() {
+    if (!trabalhador.joinable()) return;
+
+    int concluidos = arquivosConcluidos;
+    if (concluidos > progressoInformado && concluidos < TOTAL_ARQUIVOS) {
+        cout << "Exportacao: " << concluidos << "/" << TOTAL_ARQUIVOS << " arquivos" << endl;
+        progressoInformado = concluidos;
+    }
+
+    if (terminou) concluir();
+}
+
+void ExportadorAssincrono::aguardar() {
+    if (!trabalhador.joinable()) return;
+    if (!terminou) cout << "Aguardando exportacao em andamento..." << endl;
+    concluir();
+}
+
+// Junta a thread de exportação e informa o resultado
+void ExportadorAssincrono::concluir() {
+    trabalhador.join();
+
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    if (falhas == 0) {
+        cout << "Pista exportada com sucesso! (" << segundos << " s)" << endl;
+    } else {
+        cout << "Exportacao concluida com " << falhas << " erro(s)" << endl;
+    }
+}
@@ -0,0 +1,146 @@
+#include "HierarquiaCurva.h"
+#include <algorithm>
+
+// Inclui a amostra 'fim' (a primeira da folha seguinte, ou a amostra 0 na última folha):
+// assim a caixa cobre também o segmento que sai da folha
+HierarquiaCurva::Caixa HierarquiaCurva::caixaFolha(const vector<vec2>& pontos, int folha) const {
+    int inicio = folha * AMOSTRAS_POR_FOLHA_HIERARQUIA;
+    int fim = std::min(numAmostras, inicio + AMOSTRAS_POR_FOLHA_HIERARQUIA);
+
+    Caixa c = { pontos[inicio], pontos[inicio] };
+    for (int i = inicio + 1; i <= fim; i++) {
+        const vec2& p = pontos[i % numAmostras];
+        c.minimo = min(c.minimo, p);
+        c.maximo = max(c.maximo, p);
+    }
+    return c;
+}
+
+// Caixas das folhas [primeiro, ultimo] e, em cada nível acima, dos pais delas
+void HierarquiaCurva::atualizarFolhas(const vector<vec2>& pontos, int primeiro, int ultimo) {
+    for (int j = primeiro; j <= ultimo; j++) {
+        caixas[j] = caixaFolha(pontos, j);
+    }
+    for (int nivel = 1; nivel + 1 < (int)inicioNivel.size(); nivel++) {
+        primeiro /= 2;
+        ultimo /= 2;
+        for (int j = primeiro; j <= ultimo; j++) {
+            atualizarNo(nivel, j);
+        }
+    }
+}
+
+// Caixa do nó j do nível (> 0) a partir dos filhos
+void HierarquiaCurva::atualizarNo(int nivel, int j) {
+    int filhos = inicioNivel[nivel - 1];
+    int numFilhos = inicioNivel[nivel] - filhos;
+
+    Caixa c = caixas[filhos + 2 * j];
+    if (2 * j + 1 < numFilhos) {
+        const Caixa& segundo = caixas[filhos + 2 * j + 1];
+        c.minimo = min(c.minimo, segundo.minimo);
+        c.maximo = max(c.maximo, segundo.maximo);
+    }
+    caixas[inicioNivel[nivel] + j] = c;
+}
+
+void HierarquiaCurva::construir(const vector<vec2>& pontos) {
+    numAmostras = pontos.size();
+    caixas.clear();
+    inicioNivel.clear();
+    if (numAmostras == 0) return;
+
+    // Quantidade de nós de cada nível, até a raiz
+    int nos = (numAmostras + AMOSTRAS_POR_FOLHA_HIERARQUIA - 1) / AMOSTRAS_POR_FOLHA_HIERARQUIA;
+    inicioNivel.push_back(0);
+    while (true) {
+        inicioNivel.push_back(inicioNivel.back() + nos);
+        if (nos == 1) break;
+        nos = (nos + 1) / 2;
+    }
+    caixas.resize(inicioNivel.back());
+
+    for (int j = 0; j < inicioNivel[1]; j++) {
+        caixas[j] = caixaFolha(pontos, j);
+    }
+    for (int nivel = 1; nivel + 1 < (int)inicioNivel.size(); nivel++) {
+        for (int j = 0; j < inicioNivel[nivel + 1] - inicioNivel[nivel]; j++) {
+            atualizarNo(nivel, j);
+        }
+    }
+}
+
+void HierarquiaCurva::atualizar(const vector<vec2>& pontos, int inicio, int fim) {
+    if ((int)pontos.size() != numAmostras) {
+        construir(pontos);
+        return;
+    }
+    inicio = std::max(inicio, 0);
+    fim = std::min(fim, numAmostras);
+    if (fim <= inicio) return;
+
+    // A folha anterior ao intervalo também muda: a caixa dela inclui a amostra 'inicio'
+    // (na amostra 0, é a última folha da curva)
+    int ultimaFolha = inicioNivel[1] - 1;
+    int primeiro = (inicio - 1) / AMOSTRAS_POR_FOLHA_HIERARQUIA;
+    int ultimo = (fim - 1) / AMOSTRAS_POR_FOLHA_HIERARQUIA;
+    if (inicio == 0) {
+        primeiro = 0;
+        if (ultimo < ultimaFolha) atualizarFolhas(pontos, ultimaFolha, ultimaFolha);
+    }
+    atualizarFolhas(pontos, primeiro, ultimo);
+}
+
+void HierarquiaCurva::selecionar(vec2 minimo, vec2 maximo, float tamanhoPixel, uint32_t base, uint32_t quebra,
+                                 vector<uint32_t>& indices) const {
+    if (numAmostras < 2) return;
+
+    Selecao s = { minimo, maximo, tamanhoPixel, base, quebra, &indices, true, -1 };
+
+    // A curva é fechada: começa pelo segmento da última amostra até a primeira e,
+    // se o fim ainda estiver visível, termina de volta na primeira
+    indices.push_back(base + numAmostras - 1);
+    visitar(int(inicioNivel.size()) - 2, 0, s);
+    if (s.aberto) indices.push_back(base);
+    indices.push_back(quebra);
+}
+
+void HierarquiaCurva::visitar(int nivel, int j, Selecao& s) const {
+    const Caixa& c = caixas[inicioNivel[nivel] + j];
+    int tamanhoNo = AMOSTRAS_POR_FOLHA_HIERARQUIA << nivel;
+    int inicio = j * tamanhoNo;
+    int fim = std::min(numAmostras, inicio + tamanhoNo);
+
+    // Fora da vista: fecha o trecho visível com a primeira amostra do nó (o segmento que
+    // sai da vista) e guarda a última, que abre o próximo trecho visível
+    bool visivel = c.maximo.x >= s.minimo.x && c.minimo.x <= s.maximo.x &&
+                   c.maximo.y >= s.minimo.y && c.minimo.y <= s.maximo.y;
+    if (!visivel) {
+        if (s.aberto) {
+            s.indices->push_back(s.base + inicio);
+            s.indices->push_back(s.quebra);
+            s.aberto = false;
+        }
+        s.ultimoOculto = fim - 1;
+        return;
+    }
+    if (!s.aberto) {
+        if (s.ultimoOculto >= 0) s.indices->push_back(s.base + s.ultimoOculto);
+        s.aberto = true;
+    }
+
+    // Menor que um pixel: as amostras do nó (e a seguinte, onde termina o último segmento
+    // dele) ficam a menos de um pixel da primeira
+    vec2 tamanho = c.maximo - c.minimo;
+    if (std::max(tamanho.x, tamanho.y) <= s.limiar) {
+        s.indices->push_back(s.base + inicio);
+        return;
+    }
+    if (nivel == 0) {
+        for (int i = inicio; i < fim; i++) s.indices->push_back(s.base + i);
+        return;
+    }
+
+    visitar(nivel - 1, 2 * j, s);
+    if (2 * j + 1 < inicioNivel[nivel] - inicioNivel[nivel - 1]) visitar(nivel - 1, 2 * j + 1, s);
+}
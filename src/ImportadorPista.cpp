@@ -0,0 +1,433 @@
+#include "ImportadorPista.h"
+#include <iostream>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include "ArquivoMapeado.h"
+#include "ThreadPool.h"
+#include "Perfilador.h"
+
+// Bytes de texto por bloco na leitura paralela
+const size_t BYTES_POR_BLOCO_IMPORTACAO = size_t(1) << 22;
+
+// Divide o texto em blocos de tamanho parecido que terminam em fim de linha: o bloco b vai
+// de limites[b] a limites[b + 1]. A divisão depende só do tamanho do arquivo.
+static void dividirEmBlocos(const char* texto, size_t tamanho, vector<const char*>& limites) {
+    const char* fim = texto + tamanho;
+    size_t numBlocos = std::max<size_t>(1, (tamanho + BYTES_POR_BLOCO_IMPORTACAO - 1) / BYTES_POR_BLOCO_IMPORTACAO);
+
+    limites.assign(1, texto);
+    for (size_t b = 1; b < numBlocos; b++) {
+        const char* p = std::max(limites.back(), texto + tamanho / numBlocos * b);
+        const char* quebra = static_cast<const char*>(memchr(p, '\n', fim - p));
+        limites.push_back(quebra ? quebra + 1 : fim);
+    }
+    limites.push_back(fim);
+}
+
+// Resultado da leitura das linhas de um bloco; linhaErro é relativa ao início do bloco
+struct LeituraBloco {
+    size_t linhas = 0;
+    size_t linhaErro = SIZE_MAX;
+    const char* erro = nullptr;
+};
+
+// Chama interpretar(inicio, fim) para cada linha de [p, fim), sem '\n' nem '\r' final.
+// interpretar devolve a mensagem de erro da linha, ou nullptr; a leitura para no primeiro erro.
+template <typename Interpretar>
+static void lerLinhas(const char* p, const char* fim, LeituraBloco& leitura, Interpretar&& interpretar) {
+    while (p < fim) {
+        const char* quebra = static_cast<const char*>(memchr(p, '\n', fim - p));
+        const char* fimLinha = quebra ? quebra : fim;
+        if (fimLinha > p && fimLinha[-1] == '\r') fimLinha--;
+
+        if (const char* erro = interpretar(p, fimLinha)) {
+            leitura.linhaErro = leitura.linhas;
+            leitura.erro = erro;
+            return;
+        }
+        leitura.linhas++;
+        p = quebra ? quebra + 1 : fim;
+    }
+}
+
+// Informa o primeiro erro (na ordem do arquivo) com o número da linha; false se houver erro
+static bool conferirLeitura(const vector<LeituraBloco>& leituras, const string& caminho) {
+    size_t linhasAnteriores = 0;
+    for (const LeituraBloco& leitura : leituras) {
+        if (leitura.erro) {
+            cout << "Erro na linha " << linhasAnteriores + leitura.linhaErro + 1 << " de " << caminho
+                 << ": " << leitura.erro << endl;
+            return false;
+        }
+        linhasAnteriores += leitura.linhas;
+    }
+    return true;
+}
+
+static const char* pularEspacos(const char* p, const char* fim) {
+    while (p < fim && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Lê o próximo número da linha. from_chars não aceita o '+' inicial; valores fora do
+// alcance do float (ex.: 1e-50 gravado por outra ferramenta) são lidos como double e convertidos
+static bool lerReal(const char*& p, const char* fim, float& valor) {
+    p = pularEspacos(p, fim);
+    if (p < fim && *p == '+') p++;
+
+    auto resultado = from_chars(p, fim, valor);
+    if (resultado.ec == errc::result_out_of_range) {
+        double largo;
+        resultado = from_chars(p, fim, largo);
+        valor = float(largo);
+    }
+    if (resultado.ec != errc()) return false;
+    p = resultado.ptr;
+    return true;
+}
+
+static bool lerInteiro(const char*& p, const char* fim, int& valor) {
+    if (p < fim && *p == '+') p++;
+    auto resultado = from_chars(p, fim, valor);
+    if (resultado.ec != errc()) return false;
+    p = resultado.ptr;
+    return true;
+}
+
+// Primeira palavra da linha (diretiva do OBJ); p fica logo depois dela
+static bool diretiva(const char*& p, const char* fim, const char* nome) {
+    size_t n = strlen(nome);
+    if (size_t(fim - p) < n || memcmp(p, nome, n) != 0) return false;
+    if (p + n < fim && p[n] != ' ' && p[n] != '\t') return false;
+    p += n;
+    return true;
+}
+
+// Dados de um bloco de linhas do OBJ. Os cantos das faces já vêm divididos em triângulos:
+// 3 índices (v, vt, vn) por canto, começando em 0, e -1 quando o índice não existe.
+// Índices negativos do OBJ são relativos ao que foi lido antes da linha; ficam relativos
+// ao início do bloco e suas posições em 'relativos', para somar a base do bloco depois.
+struct BlocoOBJ {
+    LeituraBloco leitura;
+    vector<vec3> posicoes, normais;
+    vector<vec2> coordenadas;
+    vector<int> cantos;
+    vector<size_t> relativos;
+    vector<int> poligono;         // Rascunho: cantos da face sendo lida
+    vector<char> poligonoRelativo;
+    bool indicesValidos = true;
+    bool mesmoIndice = true;      // Todo canto usa o mesmo índice para v, vt e vn (ou não usa vt/vn)
+};
+
+// Lê "v", "v/vt", "v//vn" ou "v/vt/vn" e guarda os 3 índices em poligono
+static const char* lerCantoFace(const char*& p, const char* fim, BlocoOBJ& bloco) {
+    size_t lidos[3] = { bloco.posicoes.size(), bloco.coordenadas.size(), bloco.normais.size() };
+
+    for (int k = 0; k < 3; k++) {
+        int indice = -1;
+        bool relativo = false;
+        bool presente = k == 0 || (p < fim && *p != '/' && *p != ' ' && *p != '\t');
+        if (presente) {
+            int valor;
+            if (!lerInteiro(p, fim, valor)) return "indice de face invalido";
+            if (valor == 0) return "indice de face 0 (o OBJ comeca em 1)";
+            relativo = valor < 0;
+            indice = relativo ? int(lidos[k]) + valor : valor - 1;
+        }
+        bloco.poligono.push_back(indice);
+        bloco.poligonoRelativo.push_back(relativo);
+
+        if (k < 2) {
+            if (p < fim && *p == '/') {
+                p++;
+            } else {
+                // Canto sem os índices seguintes
+                for (int resto = k + 1; resto < 3; resto++) {
+                    bloco.poligono.push_back(-1);
+                    bloco.poligonoRelativo.push_back(false);
+                }
+                break;
+            }
+        }
+    }
+    if (p < fim && *p != ' ' && *p != '\t') return "canto de face invalido";
+    return nullptr;
+}
+
+static const char* lerLinhaOBJ(const char* p, const char* fim, BlocoOBJ& bloco) {
+    p = pularEspacos(p, fim);
+    if (p == fim || *p == '#') return nullptr;
+
+    if (diretiva(p, fim, "v")) {
+        vec3 v;
+        if (!lerReal(p, fim, v.x) || !lerReal(p, fim, v.y) || !lerReal(p, fim, v.z)) return "vertice invalido";
+        bloco.posicoes.push_back(v);
+    }
+    else if (diretiva(p, fim, "vt")) {
+        vec2 t(0.0f, 0.0f);
+        if (!lerReal(p, fim, t.x)) return "coordenada de textura invalida";
+        const char* resto = pularEspacos(p, fim);
+        if (resto < fim && !lerReal(p, fim, t.y)) return "coordenada de textura invalida";
+        bloco.coordenadas.push_back(t);
+    }
+    else if (diretiva(p, fim, "vn")) {
+        vec3 n;
+        if (!lerReal(p, fim, n.x) || !lerReal(p, fim, n.y) || !lerReal(p, fim, n.z)) return "normal invalida";
+        bloco.normais.push_back(n);
+    }
+    else if (diretiva(p, fim, "f")) {
+        bloco.poligono.clear();
+        bloco.poligonoRelativo.clear();
+        for (p = pularEspacos(p, fim); p < fim; p = pularEspacos(p, fim)) {
+            if (const char* erro = lerCantoFace(p, fim, bloco)) return erro;
+        }
+        int numCantos = bloco.poligono.size() / 3;
+        if (numCantos < 3) return "face com menos de 3 vertices";
+
+        // Leque a partir do primeiro canto
+        for (int k = 1; k + 1 < numCantos; k++) {
+            for (int canto : { 0, k, k + 1 }) {
+                for (int c = 0; c < 3; c++) {
+                    if (bloco.poligonoRelativo[canto * 3 + c]) bloco.relativos.push_back(bloco.cantos.size());
+                    bloco.cantos.push_back(bloco.poligono[canto * 3 + c]);
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+// Posição/normal do OBJ (sistema do visualizador) para o editor: Y <-> Z
+static vec3 paraEditor(vec3 v) {
+    return vec3(v.x, v.z, v.y);
+}
+
+// Cantos com índices v/vt/vn diferentes: cada combinação distinta vira um vértice
+struct ChaveCanto {
+    int v, vt, vn;
+    bool operator==(const ChaveCanto& o) const { return v == o.v && vt == o.vt && vn == o.vn; }
+};
+
+struct HashCanto {
+    size_t operator()(const ChaveCanto& c) const {
+        return (size_t(unsigned(c.v)) * 0x9E3779B97F4A7C15ull) ^ (size_t(unsigned(c.vt)) * 0xC2B2AE3D27D4EB4Full) ^ size_t(unsigned(c.vn));
+    }
+};
+
+bool lerOBJ(const string& caminho, vector<Vertex>& vertices, vector<Triangle>& triangles, bool* comNormais) {
+    PERFIL_ZONA("lerOBJ");
+    auto inicio = chrono::steady_clock::now();
+
+    ArquivoMapeado arquivo;
+    if (!arquivo.abrir(caminho)) return false;
+
+    const char* texto = reinterpret_cast<const char*>(arquivo.dados());
+    vector<const char*> limites;
+    dividirEmBlocos(texto, arquivo.tamanho(), limites);
+    int numBlocos = limites.size() - 1;
+
+    // Passo 1: cada bloco interpreta as próprias linhas
+    vector<BlocoOBJ> blocos(numBlocos);
+    ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+        for (int b = primeiro; b < ultimo; b++) {
+            lerLinhas(limites[b], limites[b + 1], blocos[b].leitura, [&](const char* p, const char* fim) {
+                return lerLinhaOBJ(p, fim, blocos[b]);
+            });
+        }
+    });
+
+    vector<LeituraBloco> leituras(numBlocos);
+    for (int b = 0; b < numBlocos; b++) leituras[b] = blocos[b].leitura;
+    if (!conferirLeitura(leituras, caminho)) return false;
+
+    // Bases de cada bloco nos vetores finais
+    vector<size_t> basePosicoes(numBlocos + 1, 0), baseCoordenadas(numBlocos + 1, 0);
+    vector<size_t> baseNormais(numBlocos + 1, 0), baseTriangulos(numBlocos + 1, 0);
+    for (int b = 0; b < numBlocos; b++) {
+        basePosicoes[b + 1] = basePosicoes[b] + blocos[b].posicoes.size();
+        baseCoordenadas[b + 1] = baseCoordenadas[b] + blocos[b].coordenadas.size();
+        baseNormais[b + 1] = baseNormais[b] + blocos[b].normais.size();
+        baseTriangulos[b + 1] = baseTriangulos[b] + blocos[b].cantos.size() / 9;
+    }
+    size_t numPosicoes = basePosicoes[numBlocos];
+    size_t numCoordenadas = baseCoordenadas[numBlocos];
+    size_t numNormais = baseNormais[numBlocos];
+    size_t numTriangulos = baseTriangulos[numBlocos];
+
+    if (numPosicoes == 0 || numTriangulos == 0) {
+        cout << "Nenhuma malha no arquivo: " << caminho << endl;
+        return false;
+    }
+
+    // Passo 2: índices relativos viram absolutos e todos são conferidos
+    ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+        for (int b = primeiro; b < ultimo; b++) {
+            BlocoOBJ& bloco = blocos[b];
+            const size_t base[3] = { basePosicoes[b], baseCoordenadas[b], baseNormais[b] };
+            for (size_t posicao : bloco.relativos) {
+                bloco.cantos[posicao] += int(base[posicao % 3]);
+            }
+
+            const long long limite[3] = { (long long)numPosicoes, (long long)numCoordenadas, (long long)numNormais };
+            for (size_t c = 0; c < bloco.cantos.size(); c += 3) {
+                int v = bloco.cantos[c], vt = bloco.cantos[c + 1], vn = bloco.cantos[c + 2];
+                if (v < 0 || v >= limite[0] || vt < -1 || vt >= limite[1] || vn < -1 || vn >= limite[2]) {
+                    bloco.indicesValidos = false;
+                    break;
+                }
+                if ((vt != -1 && vt != v) || (vn != -1 && vn != v)) bloco.mesmoIndice = false;
+            }
+        }
+    });
+
+    bool mesmoIndice = true;
+    for (const BlocoOBJ& bloco : blocos) {
+        if (!bloco.indicesValidos) {
+            cout << "Arquivo OBJ com indice de face fora do intervalo: " << caminho << endl;
+            return false;
+        }
+        mesmoIndice = mesmoIndice && bloco.mesmoIndice;
+    }
+
+    // Passo 3: monta vértices e triângulos
+    if (mesmoIndice) {
+        // Um vértice por "v", na ordem do arquivo; vt/vn de mesmo índice quando existem
+        vertices.resize(numPosicoes);
+        triangles.resize(numTriangulos);
+        ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+            for (int b = primeiro; b < ultimo; b++) {
+                const BlocoOBJ& bloco = blocos[b];
+                for (size_t k = 0; k < bloco.posicoes.size(); k++) {
+                    vertices[basePosicoes[b] + k].position = paraEditor(bloco.posicoes[k]);
+                }
+                for (size_t k = 0; k < bloco.coordenadas.size() && baseCoordenadas[b] + k < numPosicoes; k++) {
+                    vertices[baseCoordenadas[b] + k].texCoord = bloco.coordenadas[k];
+                }
+                for (size_t k = 0; k < bloco.normais.size() && baseNormais[b] + k < numPosicoes; k++) {
+                    vertices[baseNormais[b] + k].normal = paraEditor(bloco.normais[k]);
+                }
+
+                Triangle* destino = &triangles[baseTriangulos[b]];
+                for (size_t c = 0; c < bloco.cantos.size(); c += 9) {
+                    *destino++ = { bloco.cantos[c], bloco.cantos[c + 3], bloco.cantos[c + 6] };
+                }
+            }
+        });
+        for (size_t i = numCoordenadas; i < numPosicoes; i++) vertices[i].texCoord = vec2(0.0f, 0.0f);
+        for (size_t i = numNormais; i < numPosicoes; i++) vertices[i].normal = vec3(0.0f, 0.0f, 0.0f);
+    } else {
+        // Combinações distintas de v/vt/vn, na ordem em que aparecem (serial: caso raro)
+        vector<vec3> posicoes, normais;
+        vector<vec2> coordenadas;
+        posicoes.reserve(numPosicoes);
+        coordenadas.reserve(numCoordenadas);
+        normais.reserve(numNormais);
+        for (const BlocoOBJ& bloco : blocos) {
+            posicoes.insert(posicoes.end(), bloco.posicoes.begin(), bloco.posicoes.end());
+            coordenadas.insert(coordenadas.end(), bloco.coordenadas.begin(), bloco.coordenadas.end());
+            normais.insert(normais.end(), bloco.normais.begin(), bloco.normais.end());
+        }
+
+        vector<Vertex> novosVertices;
+        vector<Triangle> novosTriangulos(numTriangulos);
+        unordered_map<ChaveCanto, int, HashCanto> indiceDoCanto;
+        indiceDoCanto.reserve(numPosicoes);
+
+        size_t t = 0;
+        for (const BlocoOBJ& bloco : blocos) {
+            for (size_t c = 0; c < bloco.cantos.size(); c += 9, t++) {
+                int indices[3];
+                for (int k = 0; k < 3; k++) {
+                    ChaveCanto chave = { bloco.cantos[c + k * 3], bloco.cantos[c + k * 3 + 1], bloco.cantos[c + k * 3 + 2] };
+                    auto [it, novo] = indiceDoCanto.try_emplace(chave, int(novosVertices.size()));
+                    if (novo) {
+                        Vertex v;
+                        v.position = paraEditor(posicoes[chave.v]);
+                        v.texCoord = chave.vt >= 0 ? coordenadas[chave.vt] : vec2(0.0f, 0.0f);
+                        v.normal = chave.vn >= 0 ? paraEditor(normais[chave.vn]) : vec3(0.0f, 0.0f, 0.0f);
+                        novosVertices.push_back(v);
+                    }
+                    indices[k] = it->second;
+                }
+                novosTriangulos[t] = { indices[0], indices[1], indices[2] };
+            }
+        }
+        vertices.assign(novosVertices.begin(), novosVertices.end());
+        triangles.assign(novosTriangulos.begin(), novosTriangulos.end());
+    }
+    if (comNormais) *comNormais = numNormais > 0;
+
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "Malha importada de " << caminho << ": " << vertices.size() << " vertices e "
+         << triangles.size() << " triangulos (" << segundos * 1000.0 << " ms, "
+         << arquivo.tamanho() / 1e6 / std::max(segundos, 1e-9) << " MB/s)" << endl;
+    return true;
+}
+
+bool lerCurvaAnimacao(const string& caminho, vector<vec2>& pontos, vector<float>& alturas) {
+    PERFIL_ZONA("lerCurvaAnimacao");
+    auto inicio = chrono::steady_clock::now();
+
+    ArquivoMapeado arquivo;
+    if (!arquivo.abrir(caminho)) return false;
+
+    const char* texto = reinterpret_cast<const char*>(arquivo.dados());
+    vector<const char*> limites;
+    dividirEmBlocos(texto, arquivo.tamanho(), limites);
+    int numBlocos = limites.size() - 1;
+
+    // Cada bloco lê as próprias amostras; depois são copiadas em ordem para a saída
+    struct BlocoCurva {
+        LeituraBloco leitura;
+        vector<vec2> pontos;
+        vector<float> alturas;
+    };
+    vector<BlocoCurva> blocos(numBlocos);
+    ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+        for (int b = primeiro; b < ultimo; b++) {
+            BlocoCurva& bloco = blocos[b];
+            lerLinhas(limites[b], limites[b + 1], bloco.leitura, [&](const char* p, const char* fim) -> const char* {
+                p = pularEspacos(p, fim);
+                if (p == fim || *p == '#') return nullptr;
+
+                // "x altura z": Y do visualizador é a altura, Z volta a ser o Y do editor
+                float x, altura, z;
+                if (!lerReal(p, fim, x) || !lerReal(p, fim, altura) || !lerReal(p, fim, z)) return "amostra invalida";
+                bloco.pontos.push_back(vec2(x, z));
+                bloco.alturas.push_back(altura);
+                return nullptr;
+            });
+        }
+    });
+
+    vector<LeituraBloco> leituras(numBlocos);
+    vector<size_t> base(numBlocos + 1, 0);
+    for (int b = 0; b < numBlocos; b++) {
+        leituras[b] = blocos[b].leitura;
+        base[b + 1] = base[b] + blocos[b].pontos.size();
+    }
+    if (!conferirLeitura(leituras, caminho)) return false;
+
+    if (base[numBlocos] == 0) {
+        cout << "Nenhuma amostra de curva no arquivo: " << caminho << endl;
+        return false;
+    }
+
+    pontos.resize(base[numBlocos]);
+    alturas.resize(base[numBlocos]);
+    ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+        for (int b = primeiro; b < ultimo; b++) {
+            copy(blocos[b].pontos.begin(), blocos[b].pontos.end(), pontos.begin() + base[b]);
+            copy(blocos[b].alturas.begin(), blocos[b].alturas.end(), alturas.begin() + base[b]);
+        }
+    });
+
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cout << "Curva importada de " << caminho << ": " << pontos.size() << " amostras ("
+         << segundos * 1000.0 << " ms, " << arquivo.tamanho() / 1e6 / std::max(segundos, 1e-9) << " MB/s)" << endl;
+    return true;
+}
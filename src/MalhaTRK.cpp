@@ -0,0 +1,51 @@
+#include "MalhaTRK.h"
+#include <iostream>
+#include <cstring>
+
+bool ArquivoTRK::abrir(const string& caminho) {
+    if (!mapa.abrir(caminho)) return false;
+
+    if (mapa.tamanho() < sizeof(CabecalhoTRK)) {
+        cout << "Arquivo .trk invalido (pequeno demais): " << caminho << endl;
+        fechar();
+        return false;
+    }
+    if (!validar(caminho)) {
+        fechar();
+        return false;
+    }
+    return true;
+}
+
+// Confere assinatura, versão, tamanhos dos registros e se cada seção cabe no arquivo e
+// está alinhada. Só o cabeçalho é lido: os valores dos índices não são conferidos, o que
+// exigiria percorrer o arquivo inteiro
+bool ArquivoTRK::validar(const string& caminho) const {
+    const CabecalhoTRK& c = cabecalho();
+
+    if (memcmp(c.magia, MAGIA_TRK, sizeof(MAGIA_TRK)) != 0) {
+        cout << "Arquivo nao e uma malha .trk: " << caminho << endl;
+        return false;
+    }
+    if (c.versao != VERSAO_TRK || c.tamanhoCabecalho != sizeof(CabecalhoTRK) || c.tamanhoVertice != sizeof(Vertex)) {
+        cout << "Versao do arquivo .trk nao suportada (" << c.versao << "): " << caminho << endl;
+        return false;
+    }
+
+    // Seção [deslocamento, deslocamento + quantidade * tamanho) dentro do arquivo, sem estouro
+    auto secaoValida = [tamanho = mapa.tamanho()](uint64_t deslocamento, uint64_t quantidade, uint64_t tamanhoItem) {
+        if (deslocamento % ALINHAMENTO_TRK != 0 || deslocamento > tamanho) return false;
+        return quantidade <= (tamanho - deslocamento) / tamanhoItem;
+    };
+    if (!secaoValida(c.deslocamentoVertices, c.numVertices, sizeof(Vertex)) ||
+        !secaoValida(c.deslocamentoIndices, c.numIndices, sizeof(uint32_t)) ||
+        (c.numBlocos > 0 && !secaoValida(c.deslocamentoBlocos, c.numBlocos, sizeof(BlocoTRK)))) {
+        cout << "Arquivo .trk corrompido (secoes fora do arquivo): " << caminho << endl;
+        return false;
+    }
+    if (c.numIndices % 3 != 0) {
+        cout << "Arquivo .trk corrompido (indices nao formam triangulos): " << caminho << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+#include "NURBS.h"
+#include <algorithm>
+
+// Funções de base não nulas N[0..grau] para t no intervalo [nos[intervalo], nos[intervalo+1])
+// Cada nível d reaproveita os valores do nível d-1 (custo O(grau²) em vez de exponencial)
+void calcularBasesNaoNulas(int intervalo, float t, int grau, const float* nos, float* N) {
+    float esquerda[NURBS_GRAU_MAXIMO + 1];
+    float direita[NURBS_GRAU_MAXIMO + 1];
+    
+    N[0] = 1.0f;
+    for (int d = 1; d <= grau; d++) {
+        esquerda[d] = t - nos[intervalo + 1 - d];
+        direita[d] = nos[intervalo + d] - t;
+        
+        float acumulado = 0.0f;
+        for (int r = 0; r < d; r++) {
+            float denom = direita[r + 1] + esquerda[d - r];
+            float temp = (denom != 0.0f) ? N[r] / denom : 0.0f;
+            N[r] = acumulado + direita[r + 1] * temp;
+            acumulado = esquerda[d - r] * temp;
+        }
+        N[d] = acumulado;
+    }
+}
+
+bool CurvaNURBS::valida() const {
+    if (grau < 2 || grau > NURBS_GRAU_MAXIMO) return false;
+    if ((int)pontos.size() <= grau) return false;
+    if (nos.size() != pontos.size() + grau + 1) return false;
+    if (!pesos.empty() && pesos.size() != pontos.size()) return false;
+    
+    for (size_t i = 1; i < nos.size(); i++) {
+        if (nos[i] < nos[i - 1]) return false;
+    }
+    return nos[pontos.size()] > nos[grau];
+}
+
+int CurvaNURBS::encontrarIntervalo(float t) const {
+    int n = pontos.size();
+    
+    // Fim do domínio pertence ao último intervalo não vazio
+    if (t >= nos[n]) {
+        int i = n - 1;
+        while (i > grau && nos[i] == nos[i + 1]) i--;
+        return i;
+    }
+    if (t <= nos[grau]) return grau;
+    
+    // Primeiro nó > t, dentro de [grau+1, n]
+    auto it = upper_bound(nos.begin() + grau + 1, nos.begin() + n + 1, t);
+    return int(it - nos.begin()) - 1;
+}
+
+vec2 CurvaNURBS::avaliar(float t) const {
+    vec2 ponto;
+    avaliarLote(&t, 1, &ponto, nullptr);
+    return ponto;
+}
+
+void CurvaNURBS::avaliarLote(const float* parametros, int quantidade, vec2* saida, vec2* derivadas) const {
+    float N[NURBS_GRAU_MAXIMO + 1];
+    float M[NURBS_GRAU_MAXIMO + 1];
+    int n = pontos.size();
+    int intervalo = -1;
+    bool racional = !pesos.empty();
+    
+    for (int k = 0; k < quantidade; k++) {
+        float t = parametros[k];
+        
+        // Reaproveita o intervalo anterior se t ainda estiver dentro dele
+        if (intervalo < 0 || t < nos[intervalo] || t >= nos[intervalo + 1] || intervalo >= n) {
+            intervalo = encontrarIntervalo(t);
+        }
+        t = glm::clamp(t, nos[grau], nos[n]);
+        
+        calcularBasesNaoNulas(intervalo, t, grau, nos.data(), N);
+        
+        // Combinação dos grau+1 pontos de controle do intervalo, em coordenadas
+        // homogêneas (w·P, w) para suportar pesos racionais
+        vec2 soma(0.0f);
+        float somaPesos = 0.0f;
+        int primeiro = intervalo - grau;
+        for (int j = 0; j <= grau; j++) {
+            float w = racional ? N[j] * pesos[primeiro + j] : N[j];
+            soma += w * pontos[primeiro + j];
+            somaPesos += w;
+        }
+        
+        vec2 ponto = (racional && somaPesos != 0.0f) ? soma / somaPesos : soma;
+        saida[k] = ponto;
+        
+        if (!derivadas) continue;
+        
+        // Derivada: C'(t) = sum N(j, grau-1) * grau * (Pw[j] - Pw[j-1]) / (u[j+grau] - u[j]),
+        // com a regra do quociente para a parte racional: C' = (A' - W'·C) / W
+        calcularBasesNaoNulas(intervalo, t, grau - 1, nos.data(), M);
+        vec2 derivadaA(0.0f);
+        float derivadaW = 0.0f;
+        for (int r = 0; r < grau; r++) {
+            int j = primeiro + 1 + r;
+            float denom = nos[j + grau] - nos[j];
+            if (denom == 0.0f) continue;
+            
+            float wAtual = racional ? pesos[j] : 1.0f;
+            float wAnterior = racional ? pesos[j - 1] : 1.0f;
+            float fator = M[r] * grau / denom;
+            derivadaA += fator * (wAtual * pontos[j] - wAnterior * pontos[j - 1]);
+            derivadaW += fator * (wAtual - wAnterior);
+        }
+        
+        derivadas[k] = (racional && somaPesos != 0.0f) ? (derivadaA - derivadaW * ponto) / somaPesos : derivadaA;
+    }
+}
+
+CurvaNURBS CurvaNURBS::fechadaUniforme(const vector<vec2>& pontosFechados, int grau) {
+    CurvaNURBS curva;
+    curva.grau = grau;
+    
+    // Repete os primeiros 'grau' pontos no final para fechar a curva
+    int n = pontosFechados.size();
+    for (int i = 0; i < n + grau; i++) {
+        curva.pontos.push_back(pontosFechados[i % n]);
+    }
+    
+    // Nós uniformes inteiros: o domínio [grau, n + grau] cobre os n segmentos da curva fechada
+    for (int i = 0; i < (int)curva.pontos.size() + grau + 1; i++) {
+        curva.nos.push_back(float(i));
+    }
+    
+    return curva;
+}
@@ -0,0 +1,184 @@
+#include "Perfilador.h"
+#include "EscritorTexto.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+
+atomic<bool> Perfilador::ligado{false};
+
+// Evento em campos atômicos: a thread dona grava e gravarRastreamento lê ao mesmo tempo
+// sem corrida (relaxed: no x86 e no ARM são loads/stores comuns)
+struct EventoPerfil {
+    atomic<const char*> nome{nullptr};
+    atomic<int64_t> inicio{0};
+    atomic<int64_t> duracao{0};
+};
+
+// Buffer circular de uma thread: só ela grava (um produtor), então basta o contador de
+// eventos escritos, publicado com release depois de cada evento
+struct BufferPerfil {
+    unique_ptr<EventoPerfil[]> eventos{ new EventoPerfil[Perfilador::EVENTOS_POR_THREAD] };
+    atomic<uint64_t> escritos{0};
+    atomic<uint64_t> inicioLeitura{0};     // Eventos antes deste foram descartados (ativar)
+    uint32_t idThread = 0;
+    string nome;                            // Protegido por mutexBuffers
+    bool livre = false;                     // A thread terminou; protegido por mutexBuffers
+};
+
+// Buffers de todas as threads que já registraram. Não são liberados, então os eventos de
+// uma thread que terminou (exportação) continuam no rastreamento; o buffer dela passa para a
+// próxima thread com o mesmo nome, e exportar várias vezes não cria um buffer por exportação.
+static mutex mutexBuffers;
+static vector<unique_ptr<BufferPerfil>> buffers;
+
+struct BufferDaThread {
+    BufferPerfil* buffer = nullptr;
+    ~BufferDaThread() {
+        if (!buffer) return;
+        lock_guard<mutex> lk(mutexBuffers);
+        buffer->livre = true;
+    }
+};
+static thread_local BufferDaThread bufferDaThread;
+static thread_local string nomeDaThread;
+
+static const auto origemRelogio = chrono::steady_clock::now();
+
+static BufferPerfil* criarBufferDaThread() {
+    lock_guard<mutex> lk(mutexBuffers);
+    BufferPerfil* b = nullptr;
+    for (auto& livre : buffers) {
+        if (livre->livre && !nomeDaThread.empty() && livre->nome == nomeDaThread) {
+            b = livre.get();
+            b->livre = false;
+            break;
+        }
+    }
+    if (!b) {
+        buffers.push_back(make_unique<BufferPerfil>());
+        b = buffers.back().get();
+        b->idThread = uint32_t(buffers.size());
+        b->nome = nomeDaThread.empty() ? "thread " + to_string(b->idThread) : nomeDaThread;
+    }
+    bufferDaThread.buffer = b;
+    return b;
+}
+
+int64_t Perfilador::agora() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origemRelogio).count();
+}
+
+void Perfilador::registrar(const char* nome, int64_t inicio, int64_t fim) {
+    BufferPerfil* b = bufferDaThread.buffer ? bufferDaThread.buffer : criarBufferDaThread();
+    uint64_t i = b->escritos.load(memory_order_relaxed);
+    EventoPerfil& e = b->eventos[i & (EVENTOS_POR_THREAD - 1)];
+    e.nome.store(nome, memory_order_relaxed);
+    e.inicio.store(inicio, memory_order_relaxed);
+    e.duracao.store(fim - inicio, memory_order_relaxed);
+    b->escritos.store(i + 1, memory_order_release);
+}
+
+void Perfilador::ativar(bool ativo) {
+    if (ativo) {
+        lock_guard<mutex> lk(mutexBuffers);
+        for (auto& b : buffers) b->inicioLeitura.store(b->escritos.load(memory_order_acquire), memory_order_relaxed);
+    }
+    ligado.store(ativo, memory_order_relaxed);
+}
+
+void Perfilador::nomearThread(const string& nome) {
+    nomeDaThread = nome;
+    if (bufferDaThread.buffer) {
+        lock_guard<mutex> lk(mutexBuffers);
+        bufferDaThread.buffer->nome = nome;
+    }
+}
+
+// Tempo em microssegundos com 3 casas (o trace_event usa µs; os eventos estão em ns)
+static void escreverMicrossegundos(EscritorTexto& saida, int64_t nanossegundos) {
+    if (nanossegundos < 0) nanossegundos = 0;
+    saida.inteiro(nanossegundos / 1000);
+    int resto = int(nanossegundos % 1000);
+    char fracao[4] = { '.', char('0' + resto / 100), char('0' + resto / 10 % 10), char('0' + resto % 10) };
+    saida.texto(fracao, 4);
+}
+
+// Nomes de zona e de thread são do próprio programa; só aspas e barras precisam de escape
+static void escreverTextoJSON(EscritorTexto& saida, const char* s) {
+    saida.caractere('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') saida.caractere('\\');
+        saida.caractere(*s);
+    }
+    saida.caractere('"');
+}
+
+bool Perfilador::gravarRastreamento(const string& caminho) {
+    ofstream file(caminho, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cout << "Erro ao abrir arquivo: " << caminho << endl;
+        return false;
+    }
+
+    EscritorTexto saida(file);
+    saida.texto("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool primeiro = true;
+    size_t total = 0, perdidos = 0;
+
+    lock_guard<mutex> lk(mutexBuffers);
+    for (auto& b : buffers) {
+        saida.texto(primeiro ? "" : ",\n");
+        primeiro = false;
+        saida.texto("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        saida.inteiro(b->idThread);
+        saida.texto(",\"args\":{\"name\":");
+        escreverTextoJSON(saida, b->nome.c_str());
+        saida.texto("}}");
+
+        // Os últimos EVENTOS_POR_THREAD desde ativar(true). Os que a thread sobrescreveu
+        // enquanto eram copiados (buffer deu a volta) são descartados depois da cópia.
+        uint64_t fim = b->escritos.load(memory_order_acquire);
+        uint64_t inicio = std::max(b->inicioLeitura.load(memory_order_relaxed),
+                                   fim > EVENTOS_POR_THREAD ? fim - EVENTOS_POR_THREAD : 0);
+        vector<tuple<const char*, int64_t, int64_t>> copia;
+        copia.reserve(size_t(fim - inicio));
+        for (uint64_t i = inicio; i < fim; i++) {
+            const EventoPerfil& e = b->eventos[i & (EVENTOS_POR_THREAD - 1)];
+            copia.emplace_back(e.nome.load(memory_order_relaxed), e.inicio.load(memory_order_relaxed),
+                               e.duracao.load(memory_order_relaxed));
+        }
+        uint64_t depois = b->escritos.load(memory_order_acquire);
+        uint64_t validos = depois > EVENTOS_POR_THREAD ? depois - EVENTOS_POR_THREAD : 0;
+        size_t pular = validos > inicio ? size_t(std::min(validos, fim) - inicio) : 0;
+        perdidos += pular + size_t(inicio - b->inicioLeitura.load(memory_order_relaxed));
+
+        for (size_t k = pular; k < copia.size(); k++) {
+            saida.texto(",\n{\"name\":");
+            escreverTextoJSON(saida, get<0>(copia[k]));
+            saida.texto(",\"cat\":\"pista\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            saida.inteiro(b->idThread);
+            saida.texto(",\"ts\":");
+            escreverMicrossegundos(saida, get<1>(copia[k]));
+            saida.texto(",\"dur\":");
+            escreverMicrossegundos(saida, get<2>(copia[k]));
+            saida.caractere('}');
+            total++;
+        }
+    }
+    saida.texto("\n]}\n");
+    saida.descarregar();
+    if (!file) {
+        cout << "Erro ao gravar arquivo: " << caminho << endl;
+        return false;
+    }
+
+    cout << "Rastreamento gravado em " << caminho << ": " << total << " eventos de " << buffers.size() << " threads";
+    if (perdidos > 0) cout << " (" << perdidos << " mais antigos sobrescritos)";
+    cout << endl;
+    return true;
+}
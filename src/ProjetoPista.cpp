@@ -0,0 +1,317 @@
+#include "ProjetoPista.h"
+#include "Perfilador.h"
+#include "NURBS.h"
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+static_assert(sizeof(vec2) == 8, "vec2 deve ter 2 floats no arquivo de projeto");
+
+// Registros a partir dos quais o diário é compactado, mesmo em projetos pequenos
+const size_t REGISTROS_MINIMOS_COMPACTACAO = 4096;
+
+// Identificadores dos parâmetros no arquivo; um identificador nunca é reaproveitado
+enum IdParametro : uint32_t {
+    PARAMETRO_PONTOS_POR_SEGMENTO = 1,
+    PARAMETRO_LARGURA_PISTA = 2,
+    PARAMETRO_TESSELACAO_ADAPTATIVA = 3,
+    PARAMETRO_TOLERANCIA_CORDA = 4,
+    PARAMETRO_TOLERANCIA_ANGULO = 5,
+    PARAMETRO_ESPACAMENTO_CURVA = 6,
+    PARAMETRO_PONTES_AUTOMATICAS = 7,
+    PARAMETRO_ALTURA_PONTE = 8,
+    PARAMETRO_COMPRIMENTO_RAMPA = 9,
+    PARAMETRO_AVALIACAO_GPU = 10,
+    PARAMETRO_GRAU_CURVA = 11
+};
+
+// Chama visitar(id, campo) para cada parâmetro (ParametrosProjeto const ou não)
+template <typename Parametros, typename Visitar>
+static void visitarParametros(Parametros& p, Visitar&& visitar) {
+    visitar(PARAMETRO_PONTOS_POR_SEGMENTO, p.pontosPorSegmento);
+    visitar(PARAMETRO_LARGURA_PISTA, p.larguraDaPista);
+    visitar(PARAMETRO_TESSELACAO_ADAPTATIVA, p.tesselacaoAdaptativa);
+    visitar(PARAMETRO_TOLERANCIA_CORDA, p.toleranciaCorda);
+    visitar(PARAMETRO_TOLERANCIA_ANGULO, p.toleranciaAngulo);
+    visitar(PARAMETRO_ESPACAMENTO_CURVA, p.espacamentoCurvaAnimacao);
+    visitar(PARAMETRO_PONTES_AUTOMATICAS, p.pontesAutomaticas);
+    visitar(PARAMETRO_ALTURA_PONTE, p.alturaPonte);
+    visitar(PARAMETRO_COMPRIMENTO_RAMPA, p.comprimentoRampa);
+    visitar(PARAMETRO_AVALIACAO_GPU, p.avaliacaoNaGPU);
+    visitar(PARAMETRO_GRAU_CURVA, p.grauCurva);
+}
+
+// Valores dos parâmetros e coordenadas como os 32 bits gravados no arquivo
+static uint32_t paraBits(float v) { uint32_t b; memcpy(&b, &v, 4); return b; }
+static uint32_t paraBits(int v) { return uint32_t(v); }
+static uint32_t paraBits(bool v) { return v ? 1u : 0u; }
+static void deBits(uint32_t b, float& v) { memcpy(&v, &b, 4); }
+static void deBits(uint32_t b, int& v) { v = int32_t(b); }
+static void deBits(uint32_t b, bool& v) { v = b != 0; }
+
+static void tabelaParametros(const ParametrosProjeto& p, vector<ParametroProjeto>& tabela) {
+    tabela.clear();
+    visitarParametros(p, [&](uint32_t id, const auto& campo) { tabela.push_back({ id, paraBits(campo) }); });
+}
+
+// Identificadores desconhecidos (de versões mais novas) são ignorados
+static void aplicarParametro(ParametrosProjeto& p, uint32_t id, uint32_t valor) {
+    visitarParametros(p, [&](uint32_t idCampo, auto& campo) {
+        if (idCampo == id) deBits(valor, campo);
+    });
+}
+
+// Valores que a geração não aceita (arquivo editado à mão, por exemplo) voltam ao padrão
+static void validarParametros(ParametrosProjeto& p) {
+    const ParametrosProjeto padrao;
+    auto positivo = [](float v) { return std::isfinite(v) && v > 0.0f; };
+    auto naoNegativo = [](float v) { return std::isfinite(v) && v >= 0.0f; };
+
+    if (p.pontosPorSegmento < 1 || p.pontosPorSegmento > 100000) p.pontosPorSegmento = padrao.pontosPorSegmento;
+    if (p.grauCurva < 2 || p.grauCurva > NURBS_GRAU_MAXIMO) p.grauCurva = padrao.grauCurva;
+    if (!positivo(p.larguraDaPista)) p.larguraDaPista = padrao.larguraDaPista;
+    if (!positivo(p.toleranciaCorda)) p.toleranciaCorda = padrao.toleranciaCorda;
+    if (!positivo(p.toleranciaAngulo)) p.toleranciaAngulo = padrao.toleranciaAngulo;
+    if (!naoNegativo(p.espacamentoCurvaAnimacao)) p.espacamentoCurvaAnimacao = padrao.espacamentoCurvaAnimacao;
+    if (!naoNegativo(p.alturaPonte)) p.alturaPonte = padrao.alturaPonte;
+    if (!naoNegativo(p.comprimentoRampa)) p.comprimentoRampa = padrao.comprimentoRampa;
+}
+
+static vector<char> lerArquivoInteiro(ifstream& file) {
+    return vector<char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+ProjetoPista::ProjetoPista(const string& caminho)
+    : caminho(caminho), caminhoDiario(caminho + ".diario") { }
+
+bool ProjetoPista::ler(vector<vec2>& pontos, ParametrosProjeto& parametros) {
+    PERFIL_ZONA("ProjetoPista::ler");
+    geracao = 0;
+    bool temProjeto = lerProjeto(pontos, parametros);
+    bool temDiario = lerDiario(pontos, parametros);
+    validarParametros(parametros);
+    parametrosDiario = parametros;
+    return temProjeto || temDiario;
+}
+
+bool ProjetoPista::carregar(vector<vec2>& pontos, ParametrosProjeto& parametros) {
+    PERFIL_ZONA("ProjetoPista::carregar");
+    geracao = 0;
+    bool temProjeto = lerProjeto(pontos, parametros);
+    bool temDiario = lerDiario(pontos, parametros);
+    validarParametros(parametros);
+    parametrosDiario = parametros;
+
+    // Diário válido: as próximas edições continuam no fim dele
+    if (temDiario) {
+        diario.close();
+        diario.open(caminhoDiario, ios::binary | ios::app);
+        if (!diario.is_open()) cout << "Erro ao abrir arquivo: " << caminhoDiario << endl;
+    } else {
+        iniciarDiario();
+    }
+
+    if (!temProjeto && !temDiario) return false;
+    cout << "Projeto carregado de " << caminho << ": " << pontos.size() << " pontos de controle";
+    if (registrosDiario > 0) cout << " (" << registrosDiario << " edicoes do diario)";
+    cout << endl;
+    return true;
+}
+
+bool ProjetoPista::lerProjeto(vector<vec2>& pontos, ParametrosProjeto& parametros) {
+    ifstream file(caminho, ios::binary);
+    if (!file.is_open()) return false;   // Nenhum projeto salvo ainda
+    vector<char> dados = lerArquivoInteiro(file);
+
+    CabecalhoProjeto c;
+    if (dados.size() < sizeof(c)) {
+        cout << "Arquivo de projeto invalido (pequeno demais): " << caminho << endl;
+        return false;
+    }
+    memcpy(&c, dados.data(), sizeof(c));
+    if (memcmp(c.magia, MAGIA_PROJETO, sizeof(MAGIA_PROJETO)) != 0 || c.versao != VERSAO_PROJETO ||
+        c.tamanhoCabecalho != sizeof(CabecalhoProjeto)) {
+        cout << "Arquivo de projeto invalido ou de versao nao suportada: " << caminho << endl;
+        return false;
+    }
+    uint64_t esperado = sizeof(c) + uint64_t(c.numParametros) * sizeof(ParametroProjeto) + uint64_t(c.numPontos) * sizeof(vec2);
+    if (dados.size() != esperado) {
+        cout << "Arquivo de projeto corrompido (tamanho inesperado): " << caminho << endl;
+        return false;
+    }
+
+    const char* p = dados.data() + sizeof(c);
+    for (uint32_t k = 0; k < c.numParametros; k++, p += sizeof(ParametroProjeto)) {
+        ParametroProjeto parametro;
+        memcpy(&parametro, p, sizeof(parametro));
+        aplicarParametro(parametros, parametro.id, parametro.valor);
+    }
+    pontos.resize(c.numPontos);
+    if (c.numPontos > 0) memcpy(pontos.data(), p, size_t(c.numPontos) * sizeof(vec2));
+
+    geracao = c.geracao;
+    return true;
+}
+
+// Reaplica as edições do diário da geração atual. Um registro incompleto no fim (o
+// programa fechou no meio da escrita) é descartado e cortado do arquivo.
+bool ProjetoPista::lerDiario(vector<vec2>& pontos, ParametrosProjeto& parametros) {
+    registrosDiario = 0;
+
+    ifstream file(caminhoDiario, ios::binary);
+    if (!file.is_open()) return false;
+    vector<char> dados = lerArquivoInteiro(file);
+    file.close();
+
+    CabecalhoDiario c;
+    if (dados.size() < sizeof(c)) return false;
+    memcpy(&c, dados.data(), sizeof(c));
+    if (memcmp(c.magia, MAGIA_DIARIO, sizeof(MAGIA_DIARIO)) != 0 || c.versao != VERSAO_PROJETO) {
+        cout << "Diario do projeto invalido, ignorado: " << caminhoDiario << endl;
+        return false;
+    }
+    if (c.geracao != geracao) return false;   // De outro salvamento: o projeto já contém as edições
+
+    size_t numRegistros = (dados.size() - sizeof(c)) / sizeof(RegistroDiario);
+    for (size_t k = 0; k < numRegistros; k++) {
+        RegistroDiario r;
+        memcpy(&r, dados.data() + sizeof(c) + k * sizeof(RegistroDiario), sizeof(r));
+        vec2 ponto;
+        deBits(r.x, ponto.x);
+        deBits(r.y, ponto.y);
+
+        switch (r.tipo) {
+            case DIARIO_ADICIONAR:
+                pontos.push_back(ponto);
+                break;
+            case DIARIO_REMOVER_ULTIMO:
+                if (!pontos.empty()) pontos.pop_back();
+                break;
+            case DIARIO_MOVER:
+                if (r.indice >= 0 && size_t(r.indice) < pontos.size()) pontos[r.indice] = ponto;
+                break;
+            case DIARIO_LIMPAR:
+                pontos.clear();
+                break;
+            case DIARIO_PARAMETRO:
+                aplicarParametro(parametros, uint32_t(r.indice), r.x);
+                break;
+        }
+    }
+
+    size_t tamanhoValido = sizeof(c) + numRegistros * sizeof(RegistroDiario);
+    if (dados.size() != tamanhoValido) {
+        error_code erro;
+        filesystem::resize_file(caminhoDiario, tamanhoValido, erro);
+    }
+    registrosDiario = numRegistros;
+    return true;
+}
+
+bool ProjetoPista::salvar(const vector<vec2>& pontos, const ParametrosProjeto& parametros) {
+    PERFIL_ZONA("ProjetoPista::salvar");
+    string temporario = caminho + ".tmp";
+    uint64_t novaGeracao = geracao + 1;
+
+    vector<ParametroProjeto> tabela;
+    tabelaParametros(parametros, tabela);
+
+    CabecalhoProjeto c = {};
+    memcpy(c.magia, MAGIA_PROJETO, sizeof(MAGIA_PROJETO));
+    c.versao = VERSAO_PROJETO;
+    c.tamanhoCabecalho = sizeof(CabecalhoProjeto);
+    c.numParametros = tabela.size();
+    c.geracao = novaGeracao;
+    c.numPontos = pontos.size();
+
+    {
+        ofstream file(temporario, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            cout << "Erro ao abrir arquivo: " << temporario << endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&c), sizeof(c));
+        file.write(reinterpret_cast<const char*>(tabela.data()), tabela.size() * sizeof(ParametroProjeto));
+        file.write(reinterpret_cast<const char*>(pontos.data()), pontos.size() * sizeof(vec2));
+        if (!file) {
+            cout << "Erro ao gravar arquivo: " << temporario << endl;
+            return false;
+        }
+    }
+
+    // Troca o projeto de uma vez: um salvamento interrompido deixa o anterior intacto
+    error_code erro;
+    filesystem::rename(temporario, caminho, erro);
+    if (erro) {
+        cout << "Erro ao substituir arquivo: " << caminho << " (" << erro.message() << ")" << endl;
+        return false;
+    }
+
+    geracao = novaGeracao;
+    parametrosDiario = parametros;
+    iniciarDiario();
+    cout << "Projeto salvo em " << caminho << " (" << pontos.size() << " pontos de controle)" << endl;
+    return true;
+}
+
+// Diário vazio para a geração atual
+void ProjetoPista::iniciarDiario() {
+    diario.close();
+    diario.clear();
+    diario.open(caminhoDiario, ios::binary | ios::trunc);
+    registrosDiario = 0;
+    if (!diario.is_open()) {
+        cout << "Erro ao abrir arquivo: " << caminhoDiario << endl;
+        return;
+    }
+
+    CabecalhoDiario c = {};
+    memcpy(c.magia, MAGIA_DIARIO, sizeof(MAGIA_DIARIO));
+    c.versao = VERSAO_PROJETO;
+    c.geracao = geracao;
+    diario.write(reinterpret_cast<const char*>(&c), sizeof(c));
+    diario.flush();
+}
+
+// Um registro por edição, já enviado ao sistema: sobrevive ao fechamento do programa
+void ProjetoPista::registrar(const RegistroDiario& registro) {
+    if (!diario.is_open()) return;
+    diario.write(reinterpret_cast<const char*>(&registro), sizeof(registro));
+    diario.flush();
+    registrosDiario++;
+}
+
+void ProjetoPista::registrarAdicao(vec2 ponto) {
+    registrar({ DIARIO_ADICIONAR, 0, paraBits(ponto.x), paraBits(ponto.y) });
+}
+
+void ProjetoPista::registrarRemocao() {
+    registrar({ DIARIO_REMOVER_ULTIMO, 0, 0, 0 });
+}
+
+void ProjetoPista::registrarMovimento(int indice, vec2 ponto) {
+    registrar({ DIARIO_MOVER, indice, paraBits(ponto.x), paraBits(ponto.y) });
+}
+
+void ProjetoPista::registrarLimpeza() {
+    registrar({ DIARIO_LIMPAR, 0, 0, 0 });
+}
+
+void ProjetoPista::registrarParametros(const ParametrosProjeto& parametros) {
+    vector<ParametroProjeto> antes, depois;
+    tabelaParametros(parametrosDiario, antes);
+    tabelaParametros(parametros, depois);
+    for (size_t k = 0; k < depois.size(); k++) {
+        if (depois[k].valor != antes[k].valor) {
+            registrar({ DIARIO_PARAMETRO, int32_t(depois[k].id), depois[k].valor, 0 });
+        }
+    }
+    parametrosDiario = parametros;
+}
+
+bool ProjetoPista::diarioLongo(size_t numPontos) const {
+    return registrosDiario > std::max(REGISTROS_MINIMOS_COMPACTACAO, numPontos);
+}
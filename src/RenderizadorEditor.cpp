@@ -0,0 +1,452 @@
+#include "RenderizadorEditor.h"
+#include "Perfilador.h"
+#include <iostream>
+#include <algorithm>
+#include <glm/gtc/type_ptr.hpp>
+
+// Shader das camadas guardadas no VBO: a cor vem da região do vértice
+static const char* vertexShaderCamadas = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+
+    out vec3 vertexColor;
+
+    uniform mat4 projection;
+    uniform int inicioCamada[4];    // Primeiro vértice de cada camada no buffer
+    uniform vec3 corCamada[4];
+
+    void main()
+    {
+        gl_Position = projection * vec4(aPos, 0.0, 1.0);
+
+        // gl_VertexID conta a partir do início do buffer (inclui o 'first' do desenho)
+        int camada = 0;
+        for (int k = 1; k < 4; k++) {
+            if (gl_VertexID >= inicioCamada[k]) camada = k;
+        }
+        vertexColor = corCamada[camada];
+    }
+)";
+
+// Shader das curvas avaliadas na GPU: sem atributos, cada vértice é a amostra gl_VertexID
+// (segmento = gl_VertexID / resolucao) da B-Spline uniforme fechada, com as mesmas fórmulas
+// de TrackEditor (prepararTabelaBase, calcularPerpendicular, calcularBordas). A instância
+// escolhe a curva: 0 = centro, 1 = interna, 2 = externa.
+static const char* vertexShaderCurvasGPU = R"(
+    #version 330 core
+    out vec3 vertexColor;
+    out vec2 posicaoMundo;          // Capturada por transform feedback na verificação de paridade
+
+    uniform mat4 projection;
+    uniform samplerBuffer pontosDeControle;     // Região dos pontos de controle no VBO
+    uniform int numPontos;
+    uniform int resolucao;
+    uniform float meiaLargura;
+    uniform vec3 corCamada[3];
+
+    void main()
+    {
+        int segmento = gl_VertexID / resolucao;
+        float u = float(gl_VertexID - segmento * resolucao) / float(resolucao);
+        vec2 p0 = texelFetch(pontosDeControle, segmento % numPontos).xy;
+        vec2 p1 = texelFetch(pontosDeControle, (segmento + 1) % numPontos).xy;
+        vec2 p2 = texelFetch(pontosDeControle, (segmento + 2) % numPontos).xy;
+        vec2 p3 = texelFetch(pontosDeControle, (segmento + 3) % numPontos).xy;
+
+        float b0 = (1 - u) * (1 - u) * (1 - u) / 6.0;
+        float b1 = (3 * u * u * u - 6 * u * u + 4) / 6.0;
+        float b2 = (-3 * u * u * u + 3 * u * u + 3 * u + 1) / 6.0;
+        float b3 = u * u * u / 6.0;
+        float d0 = -(1 - u) * (1 - u) / 2.0;
+        float d1 = (3 * u * u - 4 * u) / 2.0;
+        float d2 = (-3 * u * u + 2 * u + 1) / 2.0;
+        float d3 = u * u / 2.0;
+        vec2 ponto = b0 * p0 + b1 * p1 + b2 * p2 + b3 * p3;
+        vec2 tangente = d0 * p0 + d1 * p1 + d2 * p2 + d3 * p3;
+
+        float comprimento = sqrt(tangente.x * tangente.x + tangente.y * tangente.y);
+        if (comprimento > 0.0001) tangente /= comprimento;
+        vec2 perpendicular = vec2(-tangente.y, tangente.x);
+        if (gl_InstanceID == 1) ponto = ponto - perpendicular * meiaLargura;
+        if (gl_InstanceID == 2) ponto = ponto + perpendicular * meiaLargura;
+
+        posicaoMundo = ponto;
+        gl_Position = projection * vec4(ponto, 0.0, 1.0);
+        vertexColor = corCamada[gl_InstanceID];
+    }
+)";
+
+static const char* fragmentShaderEditor = R"(
+    #version 330 core
+    in vec3 vertexColor;
+    out vec4 FragColor;
+
+    void main()
+    {
+        FragColor = vec4(vertexColor, 1.0);
+    }
+)";
+
+// Compila e linka um programa de shader do editor (0 em caso de erro). Com 'saidaCapturada',
+// essa saída do vertex shader pode ser gravada em um buffer por transform feedback.
+static GLuint criarProgramaShader(const char* vertexShaderSource, const char* fragmentShaderSource,
+                                  const char* saidaCapturada = nullptr) {
+    // Compila vertex shader
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+    glCompileShader(vertexShader);
+
+    // Verifica erros de compilação do vertex shader
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        cerr << "ERRO::VERTEX_SHADER::COMPILACAO_FALHOU\n" << infoLog << endl;
+    }
+
+    // Compila fragment shader
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+    glCompileShader(fragmentShader);
+
+    // Verifica erros de compilação do fragment shader
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        cerr << "ERRO::FRAGMENT_SHADER::COMPILACAO_FALHOU\n" << infoLog << endl;
+    }
+
+    // Cria programa de shader e linka os shaders
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    if (saidaCapturada) glTransformFeedbackVaryings(program, 1, &saidaCapturada, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+
+    // Deleta os shaders (já foram linkados ao programa)
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    // Verifica erros de linkagem
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        cerr << "ERRO::PROGRAM::LINKAGEM_FALHOU\n" << infoLog << endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool RenderizadorEditor::inicializar(int largura, int altura) {
+    programa = criarProgramaShader(vertexShaderCamadas, fragmentShaderEditor);
+    if (!programa) return false;
+    localProjecao = glGetUniformLocation(programa, "projection");
+    localInicioCamada = glGetUniformLocation(programa, "inicioCamada");
+
+    // Cores das camadas, na ordem das regiões
+    const GLfloat cores[NUM_CAMADAS * 3] = {
+        1.0f, 0.0f, 0.0f,   // Pontos de controle: vermelho
+        0.0f, 1.0f, 0.0f,   // Curva B-Spline: verde
+        0.0f, 0.0f, 1.0f,   // Curva interna: azul
+        1.0f, 1.0f, 0.0f    // Curva externa: amarelo
+    };
+    glUseProgram(programa);
+    glUniform3fv(glGetUniformLocation(programa, "corCamada"), NUM_CAMADAS, cores);
+
+    // Curvas avaliadas na GPU: mesmas cores, pontos de controle lidos do VBO como texture buffer
+    programaGPU = criarProgramaShader(vertexShaderCurvasGPU, fragmentShaderEditor, "posicaoMundo");
+    if (!programaGPU) return false;
+    localProjecaoGPU = glGetUniformLocation(programaGPU, "projection");
+    localNumPontos = glGetUniformLocation(programaGPU, "numPontos");
+    localResolucao = glGetUniformLocation(programaGPU, "resolucao");
+    localMeiaLargura = glGetUniformLocation(programaGPU, "meiaLargura");
+    glUseProgram(programaGPU);
+    glUniform3fv(glGetUniformLocation(programaGPU, "corCamada"), 3, cores + 3 * CAMADA_CURVA);
+    glUniform1i(glGetUniformLocation(programaGPU, "pontosDeControle"), 0);
+    glGenTextures(1, &texturaPontos);
+    glGenVertexArrays(1, &vaoSemAtributos);
+
+    // VAO com a posição (vec2) lida do VBO único e os índices das curvas no EBO
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vec2), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
+    // Trechos visíveis das curvas separados pelo índice de reinício
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(0xFFFFFFFFu);
+
+    for (CamadaDesenho& camada : camadas) camada = CamadaDesenho();
+    capacidadeIndices = 0;
+    quantidadeIndices = 0;
+    indicesDesenhados = 0;
+    geracaoCurvasGPU = 0;
+    camera.definirJanela(largura, altura);
+    vistaAlterada = indicesDesatualizados = true;
+    redimensionar(largura, altura);
+    return true;
+}
+
+void RenderizadorEditor::finalizar() {
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (ebo) glDeleteBuffers(1, &ebo);
+    if (vaoSemAtributos) glDeleteVertexArrays(1, &vaoSemAtributos);
+    if (texturaPontos) glDeleteTextures(1, &texturaPontos);
+    vao = vbo = ebo = vaoSemAtributos = texturaPontos = 0;
+    for (CamadaDesenho& camada : camadas) camada = CamadaDesenho();
+    if (programa) glDeleteProgram(programa);
+    if (programaGPU) glDeleteProgram(programaGPU);
+    programa = programaGPU = 0;
+    localProjecao = localInicioCamada = -1;
+    localProjecaoGPU = localNumPontos = localResolucao = localMeiaLargura = -1;
+}
+
+void RenderizadorEditor::redimensionar(int largura, int altura) {
+    if (largura <= 0 || altura <= 0) return;     // Janela minimizada
+    glViewport(0, 0, largura, altura);
+}
+
+void RenderizadorEditor::definirCamera(const CameraEditor& novaCamera) {
+    camera = novaCamera;
+    vistaAlterada = true;
+}
+
+void RenderizadorEditor::definirAvaliacaoNaGPU(bool ativo) {
+    avaliacaoNaGPU = ativo;
+    vistaAlterada = true;       // Redesenha no modo novo
+}
+
+void RenderizadorEditor::definirParametrosGPU(int resolucao, float largura) {
+    resolucaoGPU = resolucao;
+    larguraGPU = largura;
+    vistaAlterada = true;       // Redesenha com os parâmetros novos
+}
+
+bool RenderizadorEditor::curvasNaGPU(const TrackEditor& editor) const {
+    return avaliacaoNaGPU && programaGPU && resolucaoGPU > 0 && editor.curvaUniforme();
+}
+
+// Realoca o VBO quando alguma camada não cabe mais na sua região: a camada que cresceu
+// ganha 50% de folga (a curva cresce aos poucos quando os pontos são adicionados um a um),
+// as regiões são refeitas e todas as camadas são reenviadas
+void RenderizadorEditor::reservar(const vector<vec2>* const* dados) {
+    bool cabe = true;
+    for (int k = 0; k < NUM_CAMADAS; k++) {
+        if (dados[k]->size() > camadas[k].capacidade) cabe = false;
+    }
+    if (cabe) return;
+
+    size_t total = 0;
+    GLint inicios[NUM_CAMADAS];
+    for (int k = 0; k < NUM_CAMADAS; k++) {
+        CamadaDesenho& camada = camadas[k];
+        if (dados[k]->size() > camada.capacidade) {
+            camada.capacidade = std::max(dados[k]->size(), camada.capacidade + camada.capacidade / 2);
+        }
+        camada.inicio = inicios[k] = GLint(total);
+        camada.quantidade = 0;
+        camada.geracao = 0;
+        total += camada.capacidade;
+    }
+    glBufferData(GL_ARRAY_BUFFER, total * sizeof(vec2), nullptr, GL_DYNAMIC_DRAW);
+
+    glUseProgram(programa);
+    glUniform1iv(localInicioCamada, NUM_CAMADAS, inicios);
+
+    // Os pontos de controle são a primeira região, então o texel k do buffer é o ponto k
+    // (o texture buffer vai até GL_MAX_TEXTURE_BUFFER_SIZE texels, no mínimo 65536)
+    glBindTexture(GL_TEXTURE_BUFFER, texturaPontos);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, vbo);
+}
+
+// Atualiza a região da camada com 'dados' na geração 'geracao'. Com 'trechos', só essas
+// amostras mudaram desde o que já está no VBO.
+void RenderizadorEditor::enviar(CamadaDesenho& camada, const vector<vec2>& dados, uint64_t geracao,
+                                const vector<IntervaloAmostras>* trechos) {
+    PERFIL_ZONA("RenderizadorEditor::enviar");
+    if (camada.geracao == geracao) return;
+    camada.geracao = geracao;
+
+    size_t quantidade = dados.size();
+    GLintptr base = GLintptr(camada.inicio) * sizeof(vec2);
+    if (!trechos || size_t(camada.quantidade) != quantidade) {
+        if (quantidade > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, base, quantidade * sizeof(vec2), dados.data());
+            bytesEnviados += quantidade * sizeof(vec2);
+        }
+        if (&camada != &camadas[CAMADA_PONTOS]) camada.hierarquia.construir(dados);
+    } else {
+        for (const IntervaloAmostras& t : *trechos) {
+            size_t bytes = size_t(t.fim - t.inicio) * sizeof(vec2);
+            glBufferSubData(GL_ARRAY_BUFFER, base + t.inicio * sizeof(vec2), bytes, &dados[t.inicio]);
+            bytesEnviados += bytes;
+            camada.hierarquia.atualizar(dados, t.inicio, t.fim);
+        }
+    }
+    camada.quantidade = quantidade;
+    indicesDesatualizados = true;
+}
+
+// Índices das três curvas para a vista atual, enviados ao EBO (realocado só quando cresce)
+void RenderizadorEditor::selecionarIndices() {
+    PERFIL_ZONA("RenderizadorEditor::selecionarIndices");
+    // Margem de dois pixels: segmentos que só encostam na borda ainda aparecem (linha de 2 px)
+    float tamanhoPixel = camera.obterTamanhoPixel();
+    vec2 margem(2.0f * tamanhoPixel);
+    vec2 minimo = camera.obterMinimoVisivel() - margem;
+    vec2 maximo = camera.obterMaximoVisivel() + margem;
+
+    indices.clear();
+    for (int k = CAMADA_CURVA; k < NUM_CAMADAS; k++) {
+        const CamadaDesenho& camada = camadas[k];
+        if (camada.quantidade == 0) continue;
+        camada.hierarquia.selecionar(minimo, maximo, tamanhoPixel, uint32_t(camada.inicio), 0xFFFFFFFFu, indices);
+    }
+
+    glBindVertexArray(vao);
+    if (indices.size() > capacidadeIndices) {
+        capacidadeIndices = std::max(indices.size(), capacidadeIndices + capacidadeIndices / 2);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, capacidadeIndices * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (!indices.empty()) {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(uint32_t), indices.data());
+        bytesEnviados += indices.size() * sizeof(uint32_t);
+    }
+    quantidadeIndices = indices.size();
+    indicesDesatualizados = false;
+}
+
+bool RenderizadorEditor::desatualizado(const TrackEditor& editor) const {
+    if (vistaAlterada) return true;
+    if (camadas[CAMADA_PONTOS].geracao != editor.obterGeracaoPontosDeControle()) return true;
+    if (curvasNaGPU(editor)) return geracaoCurvasGPU != editor.obterGeracaoCurvas();
+    for (int k = CAMADA_CURVA; k < NUM_CAMADAS; k++) {
+        if (camadas[k].geracao != editor.obterGeracaoCurvas()) return true;
+    }
+    return false;
+}
+
+// Envia as camadas que mudaram; sem 'curvas', só os pontos de controle
+void RenderizadorEditor::enviarCamadas(const TrackEditor& editor, bool curvas) {
+    PERFIL_ZONA("RenderizadorEditor::enviarCamadas");
+    const vector<vec2>* dados[NUM_CAMADAS] = {
+        &editor.obterPontosDeControle(), &editor.obterPontosBSpline(),
+        &editor.obterCurvaInterna(), &editor.obterCurvaExterna()
+    };
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    reservar(dados);
+    enviar(camadas[CAMADA_PONTOS], *dados[CAMADA_PONTOS], editor.obterGeracaoPontosDeControle(), nullptr);
+    if (!curvas) return;
+    for (int k = CAMADA_CURVA; k < NUM_CAMADAS; k++) {
+        enviar(camadas[k], *dados[k], editor.obterGeracaoCurvas(),
+               editor.obterAmostrasAlteradas(camadas[k].geracao));
+    }
+}
+
+// Liga o programa das curvas na GPU com os pontos do editor e a resolução e a largura do
+// renderizador
+void RenderizadorEditor::prepararProgramaGPU(const TrackEditor& editor) {
+    glUseProgram(programaGPU);
+    glUniform1i(localNumPontos, GLint(editor.obterPontosDeControle().size()));
+    glUniform1i(localResolucao, resolucaoGPU);
+    glUniform1f(localMeiaLargura, larguraGPU / 2.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, texturaPontos);
+    glBindVertexArray(vaoSemAtributos);     // Sem atributos: nada é lido do VBO como vértice
+}
+
+// Curva e bordas (com largura) em um desenho instanciado, uma instância por curva
+void RenderizadorEditor::desenharCurvasNaGPU(const TrackEditor& editor) {
+    PERFIL_ZONA("RenderizadorEditor::desenharCurvasNaGPU");
+    size_t numAmostras = editor.obterPontosDeControle().size() * size_t(resolucaoGPU);
+
+    prepararProgramaGPU(editor);
+    glLineWidth(2.0f);
+    glDrawArraysInstanced(GL_LINE_LOOP, 0, GLsizei(numAmostras), larguraGPU > 0.0f ? 3 : 1);
+    geracaoCurvasGPU = editor.obterGeracaoCurvas();
+}
+
+void RenderizadorEditor::desenhar(const TrackEditor& editor) {
+    PERFIL_ZONA("RenderizadorEditor::desenhar");
+    bool gpu = curvasNaGPU(editor);
+    bytesEnviados = 0;
+    enviarCamadas(editor, !gpu);
+
+    if (gpu) {
+        if (vistaAlterada) indicesDesatualizados = true;    // Refeitos ao voltar para as amostras
+    } else if (indicesDesatualizados || vistaAlterada) {
+        selecionarIndices();
+    }
+
+    if (vistaAlterada) {
+        glUseProgram(programaGPU);
+        glUniformMatrix4fv(localProjecaoGPU, 1, GL_FALSE, value_ptr(camera.obterProjecao()));
+        glUseProgram(programa);
+        glUniformMatrix4fv(localProjecao, 1, GL_FALSE, value_ptr(camera.obterProjecao()));
+        vistaAlterada = false;
+    }
+    glUseProgram(programa);
+    glBindVertexArray(vao);
+
+    // Pontos de controle (vermelho)
+    if (camadas[CAMADA_PONTOS].quantidade > 0) {
+        glPointSize(10.0f);
+        glDrawArrays(GL_POINTS, camadas[CAMADA_PONTOS].inicio, camadas[CAMADA_PONTOS].quantidade);
+    }
+
+    // Curva B-Spline (verde) e curvas interna e externa (azul e amarelo) em um só desenho
+    if (gpu) {
+        desenharCurvasNaGPU(editor);
+        indicesDesenhados = 0;
+    } else {
+        if (quantidadeIndices > 0) {
+            glLineWidth(2.0f);
+            glDrawElements(GL_LINE_STRIP, quantidadeIndices, GL_UNSIGNED_INT, (void*)0);
+        }
+        indicesDesenhados = quantidadeIndices;
+    }
+
+    glBindVertexArray(0);
+}
+
+// Transform feedback do shader das curvas, sem rasterizar: as amostras das três curvas, na
+// ordem das instâncias
+bool RenderizadorEditor::lerCurvasDaGPU(const TrackEditor& editor, vector<vec2>& curva,
+                                        vector<vec2>& interna, vector<vec2>& externa) {
+    if (!programaGPU || resolucaoGPU < 1 || !editor.curvaUniforme()) return false;
+    enviarCamadas(editor, false);
+    size_t numAmostras = editor.obterPontosDeControle().size() * size_t(resolucaoGPU);
+
+    GLuint capturado;
+    glGenBuffers(1, &capturado);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, capturado);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, 3 * numAmostras * sizeof(vec2), nullptr, GL_STATIC_READ);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, capturado);
+
+    prepararProgramaGPU(editor);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArraysInstanced(GL_POINTS, 0, GLsizei(numAmostras), 3);
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(0);
+
+    vector<vec2>* saidas[3] = { &curva, &interna, &externa };
+    for (int k = 0; k < 3; k++) {
+        saidas[k]->resize(numAmostras);
+        glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, k * numAmostras * sizeof(vec2),
+                           numAmostras * sizeof(vec2), saidas[k]->data());
+    }
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDeleteBuffers(1, &capturado);
+    return true;
+}
@@ -0,0 +1,180 @@
+#include "ThreadPool.h"
+#include "Perfilador.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int numThreads) {
+    iniciar(numThreads);
+}
+
+ThreadPool::~ThreadPool() {
+    encerrar();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::redimensionar(int numThreads) {
+    encerrar();
+    iniciar(numThreads);
+}
+
+void ThreadPool::iniciar(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, thread::hardware_concurrency());
+    }
+    
+    parar = false;
+    filas.clear();
+    for (int i = 0; i < numThreads - 1 + VAGAS_CHAMADORES; i++) {
+        filas.push_back(make_unique<Fila>());
+    }
+    
+    // A thread que chama paraCada conta como uma das numThreads
+    for (int i = 0; i < numThreads - 1; i++) {
+        trabalhadores.emplace_back(&ThreadPool::executarTrabalhador, this, size_t(i));
+    }
+}
+
+void ThreadPool::encerrar() {
+    {
+        lock_guard<mutex> lk(mutexSinal);
+        parar = true;
+    }
+    sinal.notify_all();
+    
+    for (auto& t : trabalhadores) t.join();
+    trabalhadores.clear();
+}
+
+// Pega uma tarefa da própria fila (do fim) ou rouba de outra (do início) e executa.
+// Com 'somente', rouba só tarefas desse lote (chamador de paraCada); indice fora das filas
+// = sem fila própria.
+bool ThreadPool::tentarExecutar(size_t indice, const Lote* somente) {
+    Tarefa tarefa;
+    bool encontrou = false;
+    
+    if (indice < filas.size()) {
+        Fila& propria = *filas[indice];
+        lock_guard<mutex> lk(propria.m);
+        if (propria.tarefas.size() > propria.frente) {
+            tarefa = propria.tarefas.back();
+            propria.tarefas.pop_back();
+            encontrou = true;
+            if (propria.tarefas.size() == propria.frente) {
+                propria.tarefas.clear();
+                propria.frente = 0;
+            }
+        }
+    }
+    
+    for (size_t k = 1; !encontrou && k <= filas.size(); k++) {
+        size_t indiceOutra = (indice + k) % filas.size();
+        if (indiceOutra == indice) continue;
+        Fila& outra = *filas[indiceOutra];
+        lock_guard<mutex> lk(outra.m);
+        if (outra.tarefas.size() > outra.frente &&
+            (!somente || outra.tarefas[outra.frente].lote == somente)) {
+            tarefa = outra.tarefas[outra.frente++];
+            encontrou = true;
+            if (outra.tarefas.size() == outra.frente) {
+                outra.tarefas.clear();
+                outra.frente = 0;
+            }
+        }
+    }
+    
+    if (!encontrou) return false;
+    
+    tarefasNaFila--;
+    if (!tarefa.lote->falhou.load(memory_order_relaxed)) {
+        PERFIL_ZONA("bloco");
+        try {
+            tarefa.funcao(tarefa.contexto, tarefa.inicio, tarefa.fim);
+        } catch (...) {
+            lock_guard<mutex> lk(tarefa.lote->m);
+            if (!tarefa.lote->erro) tarefa.lote->erro = current_exception();
+            tarefa.lote->falhou = true;
+        }
+    }
+    
+    lock_guard<mutex> lkLote(tarefa.lote->m);
+    if (--tarefa.lote->restantes == 0) tarefa.lote->terminou.notify_all();
+    return true;
+}
+
+void ThreadPool::executarTrabalhador(size_t indice) {
+    Perfilador::nomearThread("trabalhador " + to_string(indice + 1));
+    
+    while (true) {
+        if (tentarExecutar(indice)) continue;
+        
+        unique_lock<mutex> lk(mutexSinal);
+        sinal.wait(lk, [this]() { return parar || tarefasNaFila > 0; });
+        if (parar) return;
+    }
+}
+
+// Vaga livre de chamador (índice da fila), ou filas.size() se todas estão em uso
+size_t ThreadPool::ocuparVaga() {
+    for (size_t i = trabalhadores.size(); i < filas.size(); i++) {
+        bool livre = false;
+        if (filas[i]->ocupada.compare_exchange_strong(livre, true)) return i;
+    }
+    return filas.size();
+}
+
+void ThreadPool::executarLote(int total, int tamanhoBloco, FuncaoBloco funcao, const void* contexto) {
+    if (total <= 0) return;
+    tamanhoBloco = std::max(1, tamanhoBloco);
+    int numBlocos = (total + tamanhoBloco - 1) / tamanhoBloco;
+    
+    // Sem trabalhadores ou com um único bloco: executa direto, na ordem
+    if (trabalhadores.empty() || numBlocos == 1) {
+        for (int b = 0; b < numBlocos; b++) {
+            PERFIL_ZONA("bloco");
+            funcao(contexto, b * tamanhoBloco, std::min(total, (b + 1) * tamanhoBloco));
+        }
+        return;
+    }
+    
+    Lote lote;
+    lote.restantes = numBlocos;
+    
+    // Contadas antes de entrar nas filas: um trabalhador que pega um bloco assim que ele
+    // é publicado não deixa o contador negativo
+    {
+        lock_guard<mutex> lk(mutexSinal);
+        tarefasNaFila += numBlocos;
+    }
+    
+    // Distribui os blocos entre as filas dos trabalhadores e a do chamador (round-robin)
+    size_t indiceChamador = ocuparVaga();
+    size_t numDestinos = trabalhadores.size() + (indiceChamador < filas.size() ? 1 : 0);
+    for (int b = 0; b < numBlocos; b++) {
+        int inicio = b * tamanhoBloco;
+        int fim = std::min(total, inicio + tamanhoBloco);
+        
+        size_t destino = b % numDestinos;
+        Fila& fila = *filas[destino < trabalhadores.size() ? destino : indiceChamador];
+        lock_guard<mutex> lk(fila.m);
+        fila.tarefas.push_back({ funcao, contexto, &lote, inicio, fim });
+    }
+    sinal.notify_all();
+    
+    // Quem chama ajuda com os blocos do próprio lote (nunca com os de outro chamador) e
+    // depois espera os que estão com os trabalhadores
+    while (true) {
+        {
+            lock_guard<mutex> lk(lote.m);
+            if (lote.restantes == 0) break;
+        }
+        if (!tentarExecutar(indiceChamador, &lote)) break;
+    }
+    
+    unique_lock<mutex> lk(lote.m);
+    lote.terminou.wait(lk, [&lote]() { return lote.restantes == 0; });
+    if (indiceChamador < filas.size()) filas[indiceChamador]->ocupada = false;
+    if (lote.erro) rethrow_exception(lote.erro);
+}
@@ -2,6 +2,71 @@
 #include <fstream>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "ThreadPool.h"
+#include "EscritorTexto.h"
+#include "MalhaTRK.h"
+#include "ImportadorPista.h"
+#include "Perfilador.h"
+
+// Quantidade de amostras por bloco de trabalho nas etapas paralelas
+const int AMOSTRAS_POR_BLOCO = 4096;
+
+// Buffers de saída: clear()/resize mantêm a capacidade entre as gerações; ao crescer,
+// reserva 25% de folga para que pequenas variações de tamanho (modo adaptativo,
+// arrastar pontos) não realoquem a cada geração
+template <typename T>
+static void reservarComFolga(vector<T>& v, size_t n) {
+    if (v.capacity() < n) v.reserve(n + n / 4);
+}
+
+template <typename T>
+static void redimensionarSaida(vector<T>& v, size_t n) {
+    reservarComFolga(v, n);
+    v.resize(n);
+}
+
+// Textura da pista, referenciada pelo material do OBJ (track.mtl) e do GLB
+const char* const TEXTURA_PISTA = "textures/asfalto.jpg";
+
+// Linhas de texto por bloco nas exportações paralelas
+const int LINHAS_POR_BLOCO_EXPORTACAO = 16384;
+
+// Grava 'total' linhas formatadas em paralelo: formatar(bloco, i) escreve a linha i.
+// Cada onda formata até blocos.size() blocos de linhas, cada um no próprio buffer, e os
+// grava na ordem; o arquivo sai igual ao da escrita serial e a memória fica limitada
+// a uma onda, mesmo em malhas muito grandes.
+template <typename Formatar>
+static void escreverLinhasEmParalelo(EscritorTexto& saida, vector<EscritorTexto>& blocos,
+                                     int total, Formatar&& formatar) {
+    int linhasPorOnda = int(blocos.size()) * LINHAS_POR_BLOCO_EXPORTACAO;
+    for (int onda = 0; onda < total; onda += linhasPorOnda) {
+        int fimOnda = std::min(total, onda + linhasPorOnda);
+        int numBlocos = (fimOnda - onda + LINHAS_POR_BLOCO_EXPORTACAO - 1) / LINHAS_POR_BLOCO_EXPORTACAO;
+        
+        ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+            for (int b = primeiro; b < ultimo; b++) {
+                int inicio = onda + b * LINHAS_POR_BLOCO_EXPORTACAO;
+                int fim = std::min(fimOnda, inicio + LINHAS_POR_BLOCO_EXPORTACAO);
+                blocos[b].limpar();
+                for (int i = inicio; i < fim; i++) formatar(blocos[b], i);
+            }
+        });
+        
+        for (int b = 0; b < numBlocos; b++) saida.texto(blocos[b].dados(), blocos[b].tamanho());
+    }
+}
+
+// Kernel vetorizado de gerarBSpline: AVX (8 amostras) ou SSE (4 amostras) quando o alvo suporta
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRACK_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRACK_SIMD_SSE
+#endif
 
 //#ifndef M_PI
 //#define M_PI 3.14159265358979323846
@@ -16,172 +81,1642 @@ TrackEditor::~TrackEditor() { }
 
 void TrackEditor::adicionarPontoDeControle(vec2 point) {
     pontosDeControle.push_back(point);
+    geracaoPontos++;
     cout << "Ponto de controle adicionado: (" << point.x << ", " << point.y << ")" << endl;
 }
 
 void TrackEditor::removerUltimoPontoDeControle() {
     if (!pontosDeControle.empty()) {
         pontosDeControle.pop_back();
+        geracaoPontos++;
         cout << "Ultimo ponto de controle removido" << endl;
     }
 }
 
 void TrackEditor::limparPontosDeControle() {
     pontosDeControle.clear();
+    geracaoPontos++;
+    descartarPista();
+    cout << "Todos os pontos limpos" << endl;
+}
+
+void TrackEditor::definirPontosDeControle(const vector<vec2>& pontos) {
+    pontosDeControle.assign(pontos.begin(), pontos.end());
+    geracaoPontos++;
+    descartarPista();
+}
+
+// Descarta curva, bordas e malha geradas a partir dos pontos de controle anteriores
+void TrackEditor::descartarPista() {
+    descartarTrechosAlterados();
     bSplinePoints.clear();
+    bSplineDerivadas.clear();
+    tabelaComprimentoValida = false;
     innerCurve.clear();
     outerCurve.clear();
     vertices.clear();
     triangles.clear();
-    cout << "Todos os pontos limpos" << endl;
+    trechosCorrigidos.clear();
+    cruzamentosPista.clear();
+    alturasAmostras.clear();
+    marcarCurvasAlteradas();
+}
+
+// Curva e bordas refeitas por inteiro: o desenho precisa reenviar tudo
+void TrackEditor::marcarCurvasAlteradas() {
+    geracaoCurvas++;
+    geracaoBaseTrecho = geracaoCurvas;
+    trechosAlterados.clear();
+}
+
+// Amostras [inicio, inicio + quantidade) alteradas no lugar; o trecho pode dar a volta no
+// fim da curva (vira dois intervalos)
+void TrackEditor::marcarAmostrasAlteradas(int inicio, int quantidade) {
+    int numPoints = bSplinePoints.size();
+    if (quantidade <= 0 || numPoints == 0) return;
+    
+    geracaoCurvas++;
+    if (quantidade >= numPoints) {
+        acrescentarTrechoAlterado(0, numPoints);
+        return;
+    }
+    inicio = (inicio % numPoints + numPoints) % numPoints;
+    int fim = inicio + quantidade;
+    if (fim > numPoints) {
+        acrescentarTrechoAlterado(inicio, numPoints);
+        acrescentarTrechoAlterado(0, fim - numPoints);
+    } else {
+        acrescentarTrechoAlterado(inicio, fim);
+    }
+}
+
+// Junta o intervalo aos que encostam nele. Os trechos das bordas corrigidas ficam
+// espalhados pela curva: acima do limite, um único intervalo cobre todos.
+void TrackEditor::acrescentarTrechoAlterado(int inicio, int fim) {
+    const size_t maximoTrechos = 256;
+    
+    for (size_t k = 0; k < trechosAlterados.size();) {
+        const IntervaloAmostras& t = trechosAlterados[k];
+        if (t.inicio <= fim && inicio <= t.fim) {
+            inicio = std::min(inicio, t.inicio);
+            fim = std::max(fim, t.fim);
+            trechosAlterados[k] = trechosAlterados.back();
+            trechosAlterados.pop_back();
+        } else {
+            k++;
+        }
+    }
+    if (trechosAlterados.size() >= maximoTrechos) {
+        for (const IntervaloAmostras& t : trechosAlterados) {
+            inicio = std::min(inicio, t.inicio);
+            fim = std::max(fim, t.fim);
+        }
+        trechosAlterados.clear();
+    }
+    trechosAlterados.push_back({ inicio, fim });
+}
+
+const vector<IntervaloAmostras>* TrackEditor::obterAmostrasAlteradas(uint64_t desde) const {
+    if (desde < geracaoBaseTrecho) return nullptr;
+    return &trechosAlterados;
+}
+
+// NURBS e curvas importadas deixam inicioSegmento vazio; a resolução das amostras não importa
+bool TrackEditor::curvaUniforme() const {
+    return !modoAdaptativo && grauAtual == 3 && resolucaoAtual > 0 && !inicioSegmento.empty() &&
+           pontosDeControle.size() >= 4;
+}
+
+// Define a quantidade de threads das etapas de geração (0 = um por núcleo)
+void TrackEditor::definirNumeroDeThreads(int numThreads) {
+    ThreadPool::global().redimensionar(numThreads);
+    cout << "Geracao usando " << ThreadPool::global().obterNumeroDeThreads() << " threads" << endl;
+}
+
+// Move um ponto de controle e marca os 4 segmentos que dependem dele
+void TrackEditor::moverPontoDeControle(int indice, vec2 novaPosicao) {
+    int n = pontosDeControle.size();
+    if (indice < 0 || indice >= n) return;
+    
+    pontosDeControle[indice] = novaPosicao;
+    geracaoPontos++;
+    
+    // O segmento s usa os pontos s..s+3, então o ponto k afeta os segmentos k-3..k
+    segmentoAlterado.resize(n, 0);
+    for (int d = 0; d < 4; d++) {
+        int s = ((indice - d) % n + n) % n;
+        if (!segmentoAlterado[s]) {
+            segmentoAlterado[s] = 1;
+            segmentosPendentes.push_back(s);
+        }
+    }
+}
+
+// Retorna o índice do ponto de controle mais próximo dentro do raio, ou -1
+int TrackEditor::encontrarPontoDeControle(vec2 posicao, float raio) const {
+    int encontrado = -1;
+    float melhor = raio * raio;
+    for (int i = 0; i < (int)pontosDeControle.size(); i++) {
+        vec2 d = pontosDeControle[i] - posicao;
+        float dist2 = d.x * d.x + d.y * d.y;
+        if (dist2 <= melhor) {
+            melhor = dist2;
+            encontrado = i;
+        }
+    }
+    return encontrado;
+}
+
+// Esquece os segmentos pendentes (após uma geração completa)
+void TrackEditor::descartarTrechosAlterados() {
+    for (int s : segmentosPendentes) {
+        if (s < (int)segmentoAlterado.size()) segmentoAlterado[s] = 0;
+    }
+    segmentosPendentes.clear();
+}
+
+// Recalcula a normal dos dois vértices da amostra i a partir dos triângulos vizinhos
+// (mesmo resultado de calcularNormais, restrito aos quads i-1 e i e somados na mesma ordem)
+void TrackEditor::recalcularNormaisAmostra(int i) {
+    int numPoints = innerCurve.size();
+    int alvo = i * 2;
+    
+    vertices[alvo].normal = vec3(0, 0, 0);
+    vertices[alvo + 1].normal = vec3(0, 0, 0);
+    
+    int anterior = (i - 1 + numPoints) % numPoints;
+    int quads[2] = { std::min(anterior, i), std::max(anterior, i) };
+    for (int q : quads) {
+        for (int t = 0; t < 2; t++) {
+            const Triangle& tri = triangles[q * 2 + t];
+            vec3 v0 = vertices[tri.v1].position;
+            vec3 faceNormal = cross(vertices[tri.v2].position - v0, vertices[tri.v3].position - v0);
+            
+            for (int idx : { tri.v1, tri.v2, tri.v3 }) {
+                if (idx == alvo || idx == alvo + 1) vertices[idx].normal += faceNormal;
+            }
+        }
+    }
+    
+    for (int k = alvo; k <= alvo + 1; k++) {
+        const vec3& n = vertices[k].normal;
+        float length = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (length > 0.0001f) {
+            vertices[k].normal /= length;
+        }
+    }
+}
+
+// Regenera todas as etapas que já estavam geradas, com os parâmetros da última geração
+void TrackEditor::regenerarCompleto() {
+    PERFIL_ZONA("TrackEditor::regenerarCompleto");
+    bool tinhaBordas = !innerCurve.empty();
+    bool tinhaMalha = !vertices.empty();
+    bool tinhaNormais = normaisCalculadas;
+    
+    if (modoAdaptativo) {
+        gerarBSplineAdaptativa(toleranciaCorda, toleranciaAngulo);
+    } else {
+        gerarBSplineDeGrau(grauAtual, resolucaoAtual);
+    }
+    if (tinhaBordas) calcularCurvasInternaExterna(larguraAtual);
+    if (tinhaMalha) triangularizarMalha();
+    if (tinhaNormais) calcularNormais();
+}
+
+// Regenera somente os trechos da curva, bordas e malha afetados pelos pontos movidos.
+// Cada etapa só é atualizada se já estava gerada e com o tamanho esperado.
+bool TrackEditor::atualizarTrechosAlterados() {
+    PERFIL_ZONA("TrackEditor::atualizarTrechosAlterados");
+    if (segmentosPendentes.empty()) return false;
+    
+    // Depois do caminho fundido só a malha existe: a edição incremental precisa da curva e
+    // das bordas, preenchidas aqui na primeira edição (sem perder os segmentos pendentes)
+    if (malhaEmFaixa && bSplinePoints.empty()) {
+        vector<int> pendentes;
+        pendentes.swap(segmentosPendentes);
+        preencherCurvasDeDepuracao();
+        segmentosPendentes.swap(pendentes);
+    }
+    
+    // A NURBS de outro grau não é avaliada por segmento: regenera tudo
+    if (grauAtual != 3 && !modoAdaptativo && !bSplinePoints.empty()) {
+        descartarTrechosAlterados();
+        regenerarCompleto();
+        return true;
+    }
+    
+    int n = pontosDeControle.size();
+    if (n < 4 || inicioSegmento.size() != size_t(n) + 1 ||
+        bSplinePoints.size() != size_t(inicioSegmento[n])) {
+        descartarTrechosAlterados();
+        return false;
+    }
+    int numPoints = bSplinePoints.size();
+    
+    // Curva: reavalia as amostras de cada segmento alterado
+    if (modoAdaptativo) {
+        for (int s : segmentosPendentes) {
+            // Se a quantidade de amostras do segmento mudou, os índices de tudo que vem
+            // depois mudam também: nesse caso regenera todas as etapas
+            parametrosAdaptativos(s, parametrosSegmento);
+            if ((int)parametrosSegmento.size() != inicioSegmento[s + 1] - inicioSegmento[s]) {
+                descartarTrechosAlterados();
+                regenerarCompleto();
+                return true;
+            }
+            avaliarBSpline(s, parametrosSegmento.data(), parametrosSegmento.size(),
+                           &bSplinePoints[inicioSegmento[s]], &bSplineDerivadas[inicioSegmento[s]], nullptr);
+        }
+    } else {
+        int res = resolucaoAtual;
+        prepararTabelaBase(res);
+        for (int s : segmentosPendentes) {
+            int inicio = inicioSegmento[s];
+            if (avaliacaoVetorizada) {
+                avaliarSegmentoVetorizado(s, res, &bSplinePoints[inicio], &bSplineDerivadas[inicio]);
+            } else {
+                avaliarSegmentoEscalar(s, res, &bSplinePoints[inicio], &bSplineDerivadas[inicio]);
+            }
+        }
+    }
+    
+    for (int s : segmentosPendentes) {
+        marcarAmostrasAlteradas(inicioSegmento[s], inicioSegmento[s + 1] - inicioSegmento[s]);
+    }
+    
+    // Bordas: cada amostra depende só da própria posição e derivada
+    bool temBordas = innerCurve.size() == size_t(numPoints) && outerCurve.size() == size_t(numPoints);
+    if (temBordas) {
+        for (int s : segmentosPendentes) {
+            for (int k = inicioSegmento[s]; k < inicioSegmento[s + 1]; k++) {
+                calcularBordasAmostra(k);
+            }
+        }
+        
+        // Laços: só perto dos segmentos alterados; os trechos restaurados e os novos
+        // também precisam ter a malha regravada (trechosRegravar)
+        if (correcaoAutoIntersecao || !trechosCorrigidos.empty()) {
+            corrigirLacosAlterados();
+        }
+    }
+    
+    // Malha: topologia não muda, só os vértices do trecho (e normais dos vizinhos)
+    bool temMalha = temBordas && vertices.size() == size_t(numPoints) * 2 &&
+                    triangles.size() == size_t(numPoints) * 2;
+    if (temMalha) {
+        for (int s : segmentosPendentes) {
+            for (int k = inicioSegmento[s]; k < inicioSegmento[s + 1]; k++) {
+                preencherVerticesAmostra(k);
+            }
+        }
+        for (const auto& t : trechosRegravar) {
+            for (int k = 0; k < t.quantidade; k++) {
+                preencherVerticesAmostra((t.inicio + k) % numPoints);
+            }
+        }
+        if (normaisCalculadas) {
+            for (int s : segmentosPendentes) {
+                for (int k = inicioSegmento[s] - 1; k <= inicioSegmento[s + 1]; k++) {
+                    recalcularNormaisAmostra((k + numPoints) % numPoints);
+                }
+            }
+            for (const auto& t : trechosRegravar) {
+                for (int k = -1; k <= t.quantidade; k++) {
+                    recalcularNormaisAmostra((t.inicio + k + numPoints) % numPoints);
+                }
+            }
+        }
+        
+        // Os cruzamentos podem ter mudado: as pontes são refeitas em concluirEdicao
+        if (pontesAutomaticas) pontesPendentes = true;
+    }
+    trechosRegravar.clear();
+    
+    descartarTrechosAlterados();
+    tabelaComprimentoValida = false;
+    return true;
+}
+
+// Avalia o segmento i da B-Spline cúbica uniforme nos parâmetros locais us[0..quantidade):
+// posição, primeira e segunda derivadas (analíticas) em uma única passada.
+// Qualquer uma das saídas pode ser nula quando não for necessária.
+void TrackEditor::avaliarBSpline(int i, const float* us, int quantidade,
+                                 vec2* posicoes, vec2* derivadas, vec2* derivadasSegundas) {
+    int n = pontosDeControle.size();
+    if (n < 4) return;  // Precisa de pelo menos 4 pontos
+    
+    // Índices com wraparound para curva fechada
+    vec2 p0 = pontosDeControle[i % n];
+    vec2 p1 = pontosDeControle[(i + 1) % n];
+    vec2 p2 = pontosDeControle[(i + 2) % n];
+    vec2 p3 = pontosDeControle[(i + 3) % n];
+    
+    for (int j = 0; j < quantidade; j++) {
+        float u = us[j];
+        
+        if (posicoes) {
+            // Matriz de base B-Spline cúbica
+            float b0 = (1 - u) * (1 - u) * (1 - u) / 6.0f;
+            float b1 = (3 * u * u * u - 6 * u * u + 4) / 6.0f;
+            float b2 = (-3 * u * u * u + 3 * u * u + 3 * u + 1) / 6.0f;
+            float b3 = u * u * u / 6.0f;
+            posicoes[j] = b0 * p0 + b1 * p1 + b2 * p2 + b3 * p3;
+        }
+        if (derivadas) {
+            // Derivadas das funções de base em u
+            float d0 = -(1 - u) * (1 - u) / 2.0f;
+            float d1 = (3 * u * u - 4 * u) / 2.0f;
+            float d2 = (-3 * u * u + 2 * u + 1) / 2.0f;
+            float d3 = u * u / 2.0f;
+            derivadas[j] = d0 * p0 + d1 * p1 + d2 * p2 + d3 * p3;
+        }
+        if (derivadasSegundas) {
+            derivadasSegundas[j] = (1 - u) * p0 + (3 * u - 2) * p1 + (1 - 3 * u) * p2 + u * p3;
+        }
+    }
+}
+
+// Calcula os pesos b0..b3 (posição) e d0..d3 (derivada) para cada amostra j/resolution
+// de um segmento (mesmas fórmulas de avaliarBSpline, feitas uma única vez por resolução)
+void TrackEditor::prepararTabelaBase(int resolution) {
+    if (resolucaoTabela == resolution) return;
+    
+    tabelaB0.resize(resolution);
+    tabelaB1.resize(resolution);
+    tabelaB2.resize(resolution);
+    tabelaB3.resize(resolution);
+    tabelaD0.resize(resolution);
+    tabelaD1.resize(resolution);
+    tabelaD2.resize(resolution);
+    tabelaD3.resize(resolution);
+    
+    for (int j = 0; j < resolution; j++) {
+        float u = float(j) / float(resolution);
+        tabelaB0[j] = (1 - u) * (1 - u) * (1 - u) / 6.0f;
+        tabelaB1[j] = (3 * u * u * u - 6 * u * u + 4) / 6.0f;
+        tabelaB2[j] = (-3 * u * u * u + 3 * u * u + 3 * u + 1) / 6.0f;
+        tabelaB3[j] = u * u * u / 6.0f;
+        tabelaD0[j] = -(1 - u) * (1 - u) / 2.0f;
+        tabelaD1[j] = (3 * u * u - 4 * u) / 2.0f;
+        tabelaD2[j] = (-3 * u * u + 2 * u + 1) / 2.0f;
+        tabelaD3[j] = u * u / 2.0f;
+    }
+    
+    resolucaoTabela = resolution;
+}
+
+// Avalia posição e derivada de todas as amostras do segmento i (caminho escalar de referência)
+void TrackEditor::avaliarSegmentoEscalar(int i, int resolution, vec2* saida, vec2* derivadas) {
+    int n = pontosDeControle.size();
+    vec2 p0 = pontosDeControle[i % n];
+    vec2 p1 = pontosDeControle[(i + 1) % n];
+    vec2 p2 = pontosDeControle[(i + 2) % n];
+    vec2 p3 = pontosDeControle[(i + 3) % n];
+    
+    for (int j = 0; j < resolution; j++) {
+        saida[j] = tabelaB0[j] * p0 + tabelaB1[j] * p1 + tabelaB2[j] * p2 + tabelaB3[j] * p3;
+        derivadas[j] = tabelaD0[j] * p0 + tabelaD1[j] * p1 + tabelaD2[j] * p2 + tabelaD3[j] * p3;
+    }
+}
+
+#if defined(TRACK_SIMD_AVX)
+// Combinação w0*c0 + w1*c1 + w2*c2 + w3*c3 de 8 amostras, na mesma ordem do caminho escalar
+static inline __m256 combinar8(__m256 w0, __m256 w1, __m256 w2, __m256 w3,
+                               __m256 c0, __m256 c1, __m256 c2, __m256 c3) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w0, c0), _mm256_mul_ps(w1, c1)),
+                                       _mm256_mul_ps(w2, c2)), _mm256_mul_ps(w3, c3));
+}
+
+// Intercala SoA (x[], y[]) de 8 amostras -> (x, y) por amostra
+static inline void gravarIntercalado8(float* out, __m256 x, __m256 y) {
+    __m256 lo = _mm256_unpacklo_ps(x, y);  // amostras 0,1 | 4,5
+    __m256 hi = _mm256_unpackhi_ps(x, y);  // amostras 2,3 | 6,7
+    _mm256_storeu_ps(out,     _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+#elif defined(TRACK_SIMD_SSE)
+// Combinação w0*c0 + w1*c1 + w2*c2 + w3*c3 de 4 amostras, na mesma ordem do caminho escalar
+static inline __m128 combinar4(__m128 w0, __m128 w1, __m128 w2, __m128 w3,
+                               __m128 c0, __m128 c1, __m128 c2, __m128 c3) {
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, c0), _mm_mul_ps(w1, c1)),
+                                 _mm_mul_ps(w2, c2)), _mm_mul_ps(w3, c3));
+}
+
+// Intercala SoA (x[], y[]) de 4 amostras -> (x, y) por amostra
+static inline void gravarIntercalado4(float* out, __m128 x, __m128 y) {
+    _mm_storeu_ps(out,     _mm_unpacklo_ps(x, y));
+    _mm_storeu_ps(out + 4, _mm_unpackhi_ps(x, y));
+}
+#endif
+
+// Avalia posição e derivada de todas as amostras do segmento i com SIMD. A ordem das
+// operações (sem FMA) é a mesma do caminho escalar, então o resultado é idêntico bit a bit.
+void TrackEditor::avaliarSegmentoVetorizado(int i, int resolution, vec2* saida, vec2* derivadas) {
+    int n = pontosDeControle.size();
+    vec2 p0 = pontosDeControle[i % n];
+    vec2 p1 = pontosDeControle[(i + 1) % n];
+    vec2 p2 = pontosDeControle[(i + 2) % n];
+    vec2 p3 = pontosDeControle[(i + 3) % n];
+    
+    const float* b0 = tabelaB0.data();
+    const float* b1 = tabelaB1.data();
+    const float* b2 = tabelaB2.data();
+    const float* b3 = tabelaB3.data();
+    const float* d0 = tabelaD0.data();
+    const float* d1 = tabelaD1.data();
+    const float* d2 = tabelaD2.data();
+    const float* d3 = tabelaD3.data();
+    float* out = &saida[0].x;       // vec2 é armazenado como (x, y) contíguos
+    float* outD = &derivadas[0].x;
+    int j = 0;
+    
+#if defined(TRACK_SIMD_AVX)
+    __m256 x0 = _mm256_set1_ps(p0.x), x1 = _mm256_set1_ps(p1.x), x2 = _mm256_set1_ps(p2.x), x3 = _mm256_set1_ps(p3.x);
+    __m256 y0 = _mm256_set1_ps(p0.y), y1 = _mm256_set1_ps(p1.y), y2 = _mm256_set1_ps(p2.y), y3 = _mm256_set1_ps(p3.y);
+    for (; j + 8 <= resolution; j += 8) {
+        __m256 w0 = _mm256_loadu_ps(b0 + j), w1 = _mm256_loadu_ps(b1 + j);
+        __m256 w2 = _mm256_loadu_ps(b2 + j), w3 = _mm256_loadu_ps(b3 + j);
+        gravarIntercalado8(out + 2 * j, combinar8(w0, w1, w2, w3, x0, x1, x2, x3),
+                                        combinar8(w0, w1, w2, w3, y0, y1, y2, y3));
+        
+        __m256 v0 = _mm256_loadu_ps(d0 + j), v1 = _mm256_loadu_ps(d1 + j);
+        __m256 v2 = _mm256_loadu_ps(d2 + j), v3 = _mm256_loadu_ps(d3 + j);
+        gravarIntercalado8(outD + 2 * j, combinar8(v0, v1, v2, v3, x0, x1, x2, x3),
+                                         combinar8(v0, v1, v2, v3, y0, y1, y2, y3));
+    }
+#elif defined(TRACK_SIMD_SSE)
+    __m128 x0 = _mm_set1_ps(p0.x), x1 = _mm_set1_ps(p1.x), x2 = _mm_set1_ps(p2.x), x3 = _mm_set1_ps(p3.x);
+    __m128 y0 = _mm_set1_ps(p0.y), y1 = _mm_set1_ps(p1.y), y2 = _mm_set1_ps(p2.y), y3 = _mm_set1_ps(p3.y);
+    for (; j + 4 <= resolution; j += 4) {
+        __m128 w0 = _mm_loadu_ps(b0 + j), w1 = _mm_loadu_ps(b1 + j);
+        __m128 w2 = _mm_loadu_ps(b2 + j), w3 = _mm_loadu_ps(b3 + j);
+        gravarIntercalado4(out + 2 * j, combinar4(w0, w1, w2, w3, x0, x1, x2, x3),
+                                        combinar4(w0, w1, w2, w3, y0, y1, y2, y3));
+        
+        __m128 v0 = _mm_loadu_ps(d0 + j), v1 = _mm_loadu_ps(d1 + j);
+        __m128 v2 = _mm_loadu_ps(d2 + j), v3 = _mm_loadu_ps(d3 + j);
+        gravarIntercalado4(outD + 2 * j, combinar4(v0, v1, v2, v3, x0, x1, x2, x3),
+                                         combinar4(v0, v1, v2, v3, y0, y1, y2, y3));
+    }
+#endif
+    
+    // Amostras restantes (ou todas, sem SIMD)
+    for (; j < resolution; j++) {
+        saida[j] = b0[j] * p0 + b1[j] * p1 + b2[j] * p2 + b3[j] * p3;
+        derivadas[j] = d0[j] * p0 + d1[j] * p1 + d2[j] * p2 + d3[j] * p3;
+    }
+}
+
+// Avalia a curva uniforme com 'resolution' amostras por segmento em bSplinePoints/bSplineDerivadas
+void TrackEditor::avaliarCurvaUniforme(int resolution) {
+    PERFIL_ZONA("TrackEditor::avaliarCurvaUniforme");
+    int n = pontosDeControle.size();
+    
+    // Pesos da base calculados uma vez; saída dimensionada antes da avaliação
+    prepararTabelaBase(resolution);
+    resolucaoAtual = resolution;
+    grauAtual = 3;
+    modoAdaptativo = false;
+    tabelaComprimentoValida = false;
+    descartarTrechosAlterados();
+    redimensionarSaida(bSplinePoints, size_t(n) * resolution);
+    redimensionarSaida(bSplineDerivadas, size_t(n) * resolution);
+    
+    inicioSegmento.resize(n + 1);
+    for (int i = 0; i <= n; i++) {
+        inicioSegmento[i] = i * resolution;
+    }
+    
+    // Gera pontos ao longo da curva B-Spline fechada; cada bloco de segmentos
+    // escreve na sua própria fatia da saída
+    int segmentosPorBloco = std::max(1, AMOSTRAS_POR_BLOCO / resolution);
+    ThreadPool::global().paraCada(n, segmentosPorBloco, [&](int primeiro, int ultimo) {
+        for (int i = primeiro; i < ultimo; i++) {
+            size_t inicio = size_t(i) * resolution;
+            if (avaliacaoVetorizada) {
+                avaliarSegmentoVetorizado(i, resolution, &bSplinePoints[inicio], &bSplineDerivadas[inicio]);
+            } else {
+                avaliarSegmentoEscalar(i, resolution, &bSplinePoints[inicio], &bSplineDerivadas[inicio]);
+            }
+        }
+    });
+}
+
+void TrackEditor::gerarBSpline(int resolution) {
+    PERFIL_ZONA("TrackEditor::gerarBSpline");
+    bSplinePoints.clear();
+    bSplineDerivadas.clear();
+    tabelaComprimentoValida = false;
+    marcarCurvasAlteradas();
+    
+    int n = pontosDeControle.size();
+    if (n < 4) {
+        cout << "Necessario pelo menos 4 pontos de controle para gerar B-Spline" << endl;
+        return;
+    }
+    
+    avaliarCurvaUniforme(resolution);
+    
+    cout << "B-Spline gerada com " << bSplinePoints.size() << " pontos" << endl;
+}
+
+// Caminho fundido: avalia cada amostra, calcula as bordas e grava os vértices e o par de
+// triângulos no mesmo laço, sem materializar bSplinePoints/innerCurve/outerCurve.
+// Usa o mesmo kernel e as mesmas fórmulas das etapas separadas, então a malha é idêntica.
+void TrackEditor::gerarPistaFundida(int resolution, float trackWidth) {
+    PERFIL_ZONA("TrackEditor::gerarPistaFundida");
+    bSplinePoints.clear();
+    bSplineDerivadas.clear();
+    innerCurve.clear();
+    outerCurve.clear();
+    vertices.clear();
+    triangles.clear();
+    trechosCorrigidos.clear();
+    cruzamentosPista.clear();
+    alturasAmostras.clear();
+    tabelaComprimentoValida = false;
+    normaisCalculadas = false;
+    malhaEmFaixa = false;
+    marcarCurvasAlteradas();
+    
+    int n = pontosDeControle.size();
+    if (n < 4 || resolution < 1) {
+        cout << "Necessario pelo menos 4 pontos de controle para gerar a pista" << endl;
+        return;
+    }
+    
+    prepararTabelaBase(resolution);
+    resolucaoAtual = resolution;
+    grauAtual = 3;
+    larguraAtual = trackWidth;
+    modoAdaptativo = false;
+    descartarTrechosAlterados();
+    
+    inicioSegmento.resize(n + 1);
+    for (int i = 0; i <= n; i++) {
+        inicioSegmento[i] = i * resolution;
+    }
+    
+    int numPoints = n * resolution;
+    redimensionarSaida(vertices, size_t(numPoints) * 2);
+    redimensionarSaida(triangles, size_t(numPoints) * 2);
+    
+    // Rascunho de um segmento por bloco (reaproveitado entre os segmentos do bloco),
+    // reservado na arena antes do lote: as tarefas não alocam
+    EscopoRascunho escopo(*this);
+    int segmentosPorBloco = std::max(1, AMOSTRAS_POR_BLOCO / resolution);
+    int numBlocos = (n + segmentosPorBloco - 1) / segmentosPorBloco;
+    pmr::vector<vec2> rascunhoPontos(size_t(numBlocos) * resolution, rascunho.recurso());
+    pmr::vector<vec2> rascunhoDerivadas(size_t(numBlocos) * resolution, rascunho.recurso());
+    
+    ThreadPool::global().paraCada(n, segmentosPorBloco, [&](int primeiro, int ultimo) {
+        size_t bloco = size_t(primeiro / segmentosPorBloco) * resolution;
+        vec2* pontos = &rascunhoPontos[bloco];
+        vec2* derivadas = &rascunhoDerivadas[bloco];
+        
+        for (int i = primeiro; i < ultimo; i++) {
+            if (avaliacaoVetorizada) {
+                avaliarSegmentoVetorizado(i, resolution, pontos, derivadas);
+            } else {
+                avaliarSegmentoEscalar(i, resolution, pontos, derivadas);
+            }
+            
+            for (int j = 0; j < resolution; j++) {
+                vec2 innerPoint, outerPoint;
+                calcularBordas(pontos[j], derivadas[j], innerPoint, outerPoint);
+                escreverAmostraMalha(i * resolution + j, numPoints, innerPoint, outerPoint);
+            }
+        }
+    });
+    
+    // Laços das bordas: a mesma correção de calcularCurvasInternaExterna, sobre as posições
+    // dos vértices (as bordas não ficam guardadas); só as amostras colapsadas são regravadas
+    if (correcaoAutoIntersecao) {
+        pmr::vector<vec2> interna(numPoints, rascunho.recurso());
+        pmr::vector<vec2> externa(numPoints, rascunho.recurso());
+        for (int i = 0; i < numPoints; i++) {
+            interna[i] = vec2(vertices[i * 2].position);
+            externa[i] = vec2(vertices[i * 2 + 1].position);
+        }
+        corrigirLacosCurva(interna.data(), numPoints, true, 0, numPoints);
+        corrigirLacosCurva(externa.data(), numPoints, false, 0, numPoints);
+        for (const auto& t : trechosCorrigidos) {
+            for (int k = 0; k < t.quantidade; k++) {
+                int p = (t.inicio + k) % numPoints;
+                escreverAmostraMalha(p, numPoints, interna[p], externa[p]);
+            }
+        }
+    }
+    malhaEmFaixa = true;
+    
+    cout << "Pista gerada (caminho fundido) com " << vertices.size() << " vertices e "
+         << triangles.size() << " triangulos" << endl;
+    
+    if (pontesAutomaticas) aplicarPontes();
+}
+
+// Preenche sob demanda a curva e as bordas (desenho, exportação e edição) depois do
+// caminho fundido; sem efeito se já estão preenchidas ou se a malha não é do caminho fundido
+void TrackEditor::preencherCurvasDeDepuracao() {
+    PERFIL_ZONA("TrackEditor::preencherCurvasDeDepuracao");
+    int n = pontosDeControle.size();
+    if (!malhaEmFaixa || n < 4 || resolucaoAtual < 1) return;
+    
+    int numPoints = vertices.size() / 2;
+    if (numPoints != n * resolucaoAtual) return;
+    if (bSplinePoints.size() == size_t(numPoints) && innerCurve.size() == size_t(numPoints) &&
+        outerCurve.size() == size_t(numPoints)) return;
+    
+    if (bSplinePoints.size() != size_t(numPoints)) {
+        avaliarCurvaUniforme(resolucaoAtual);
+    }
+    
+    // As bordas são exatamente as posições (x, y) dos vértices interno/externo
+    redimensionarSaida(innerCurve, numPoints);
+    redimensionarSaida(outerCurve, numPoints);
+    ThreadPool::global().paraCada(numPoints, AMOSTRAS_POR_BLOCO, [&](int inicio, int fim) {
+        for (int i = inicio; i < fim; i++) {
+            innerCurve[i] = vec2(vertices[i * 2].position);
+            outerCurve[i] = vec2(vertices[i * 2 + 1].position);
+        }
+    });
+    marcarCurvasAlteradas();
+}
+
+// Curvatura |C' x C''| / |C'|³ a partir das derivadas
+static float curvatura(vec2 d1, vec2 d2) {
+    float velocidade = sqrt(d1.x * d1.x + d1.y * d1.y);
+    if (velocidade < 0.0001f) return 0.0f;
+    
+    return fabs(d1.x * d2.y - d1.y * d2.x) / (velocidade * velocidade * velocidade);
+}
+
+// Parâmetros locais (início de cada sub-intervalo) do segmento i, subdividindo por bisseção
+// até que o erro de corda e o ângulo de cada sub-intervalo fiquem dentro das tolerâncias
+void TrackEditor::parametrosAdaptativos(int i, vector<float>& us) {
+    const int profundidadeMaxima = 10;  // No máximo 1024 amostras por segmento
+    
+    struct Intervalo { float a, b; int profundidade; };
+    Intervalo pilha[profundidadeMaxima + 2];
+    int topo = 0;
+    pilha[topo++] = { 0.0f, 1.0f, 0 };
+    
+    us.clear();
+    while (topo > 0) {
+        Intervalo iv = pilha[--topo];
+        float m = 0.5f * (iv.a + iv.b);
+        
+        // Posição e derivadas nas pontas e no meio do sub-intervalo, em uma chamada
+        float params[3] = { iv.a, m, iv.b };
+        vec2 pts[3], d1[3], d2[3];
+        avaliarBSpline(i, params, 3, pts, d1, d2);
+        
+        // Comprimento aproximado e curvatura máxima (analítica) do sub-intervalo
+        float comprimento = length(pts[1] - pts[0]) + length(pts[2] - pts[1]);
+        float kappa = std::max(curvatura(d1[0], d2[0]),
+                      std::max(curvatura(d1[1], d2[1]), curvatura(d1[2], d2[2])));
+        
+        // Flecha de um arco de comprimento L e curvatura k ~ L²k/8; ângulo varrido ~ Lk
+        float flecha = std::max(comprimento * comprimento * kappa / 8.0f,
+                                length(pts[1] - 0.5f * (pts[0] + pts[2])));
+        float angulo = comprimento * kappa;
+        
+        bool aceita = (flecha <= toleranciaCorda && angulo <= toleranciaAngulo) ||
+                      iv.profundidade >= profundidadeMaxima;
+        
+        if (aceita) {
+            us.push_back(iv.a);
+        } else {
+            // Empilha a metade direita primeiro para emitir os parâmetros em ordem crescente
+            pilha[topo++] = { m, iv.b, iv.profundidade + 1 };
+            pilha[topo++] = { iv.a, m, iv.profundidade + 1 };
+        }
+    }
+}
+
+// Gera a curva B-Spline com quantidade variável de amostras por segmento, conforme a curvatura
+void TrackEditor::gerarBSplineAdaptativa(float toleranciaDeCorda, float toleranciaDeAngulo) {
+    PERFIL_ZONA("TrackEditor::gerarBSplineAdaptativa");
+    bSplinePoints.clear();
+    bSplineDerivadas.clear();
+    tabelaComprimentoValida = false;
+    marcarCurvasAlteradas();
+    
+    int n = pontosDeControle.size();
+    if (n < 4) {
+        cout << "Necessario pelo menos 4 pontos de controle para gerar B-Spline" << endl;
+        return;
+    }
+    
+    toleranciaCorda = toleranciaDeCorda;
+    toleranciaAngulo = toleranciaDeAngulo;
+    modoAdaptativo = true;
+    descartarTrechosAlterados();
+    
+    // Passo 1: parâmetros de todos os segmentos (define o tamanho exato da saída)
+    EscopoRascunho escopo(*this);
+    pmr::vector<float> parametros(rascunho.recurso());
+    parametros.reserve(size_t(n) * 64);
+    inicioSegmento.resize(n + 1);
+    for (int i = 0; i < n; i++) {
+        parametrosAdaptativos(i, parametrosSegmento);
+        inicioSegmento[i] = parametros.size();
+        parametros.insert(parametros.end(), parametrosSegmento.begin(), parametrosSegmento.end());
+    }
+    inicioSegmento[n] = parametros.size();
+    
+    // Passo 2: avaliação, cada segmento na sua fatia da saída
+    redimensionarSaida(bSplinePoints, parametros.size());
+    redimensionarSaida(bSplineDerivadas, parametros.size());
+    ThreadPool::global().paraCada(n, 64, [&](int primeiro, int ultimo) {
+        for (int i = primeiro; i < ultimo; i++) {
+            int inicio = inicioSegmento[i];
+            avaliarBSpline(i, &parametros[inicio], inicioSegmento[i + 1] - inicio,
+                           &bSplinePoints[inicio], &bSplineDerivadas[inicio], nullptr);
+        }
+    });
+    
+    cout << "B-Spline adaptativa gerada com " << bSplinePoints.size() << " pontos" << endl;
+}
+
+// Gera a curva a partir de uma NURBS geral (grau 2..7, nós não uniformes, pesos)
+// com 'resolution' amostras por intervalo de nós não vazio
+void TrackEditor::gerarNURBS(const CurvaNURBS& curva, int resolution) {
+    PERFIL_ZONA("TrackEditor::gerarNURBS");
+    bSplinePoints.clear();
+    bSplineDerivadas.clear();
+    tabelaComprimentoValida = false;
+    inicioSegmento.clear();  // Amostragem não segue os segmentos de pontosDeControle
+    descartarTrechosAlterados();
+    marcarCurvasAlteradas();
+    
+    if (!curva.valida() || resolution < 1) {
+        cout << "Curva NURBS invalida (grau, nos ou pesos inconsistentes)" << endl;
+        return;
+    }
+    
+    // Parâmetros de todas as amostras, avaliados em um único lote
+    EscopoRascunho escopo(*this);
+    pmr::vector<float> parametros(rascunho.recurso());
+    size_t intervalosNaoVazios = 0;
+    for (int s = curva.grau; s < (int)curva.pontos.size(); s++) {
+        if (curva.nos[s + 1] > curva.nos[s]) intervalosNaoVazios++;
+    }
+    parametros.reserve(intervalosNaoVazios * resolution);
+    for (int s = curva.grau; s < (int)curva.pontos.size(); s++) {
+        float a = curva.nos[s];
+        float b = curva.nos[s + 1];
+        if (b <= a) continue;
+        for (int j = 0; j < resolution; j++) {
+            parametros.push_back(a + (b - a) * float(j) / float(resolution));
+        }
+    }
+    
+    redimensionarSaida(bSplinePoints, parametros.size());
+    redimensionarSaida(bSplineDerivadas, parametros.size());
+    curva.avaliarLote(parametros.data(), parametros.size(), bSplinePoints.data(), bSplineDerivadas.data());
+    
+    cout << "Curva NURBS de grau " << curva.grau << " gerada com " << bSplinePoints.size() << " pontos" << endl;
+}
+
+void TrackEditor::gerarBSplineDeGrau(int grau, int resolution) {
+    if (grau == 3) {
+        gerarBSpline(resolution);
+        return;
+    }
+    if (pontosDeControle.size() < 4) {
+        cout << "Necessario pelo menos 4 pontos de controle para gerar B-Spline" << endl;
+        return;
+    }
+    
+    gerarNURBS(CurvaNURBS::fechadaUniforme(pontosDeControle, grau), resolution);
+    resolucaoAtual = resolution;
+    grauAtual = grau;
+    modoAdaptativo = false;
+}
+
+// Calcula o vetor perpendicular normalizado a partir da tangente (derivada) da curva
+vec2 TrackEditor::calcularPerpendicular(vec2 tangent) {
+    // Normaliza o vetor tangente
+    float length = sqrt(tangent.x * tangent.x + tangent.y * tangent.y);
+    if (length > 0.0001f) {
+        tangent /= length;
+    }
+    
+    // Perpendicular (rotação 90° no sentido anti-horário)
+    vec2 perpendicular(-tangent.y, tangent.x);
+    
+    return perpendicular;
+}
+
+// Calcula o ângulo entre dois vetores
+float TrackEditor::calcularAngulo(vec2 v1, vec2 v2) {
+    // Normaliza os vetores
+    float len1 = sqrt(v1.x * v1.x + v1.y * v1.y);
+    float len2 = sqrt(v2.x * v2.x + v2.y * v2.y);
+    
+    if (len1 < 0.0001f || len2 < 0.0001f) return 0.0f;
+    
+    v1 /= len1;
+    v2 /= len2;
+    
+    // Produto escalar para o cosseno do ângulo
+    float dot = v1.x * v2.x + v1.y * v2.y;
+    
+    // Limita o valor para evitar erros numéricos
+    dot = glm::clamp(dot, -1.0f, 1.0f);
+    
+    return acos(dot);
+}
+
+// Calcula os pontos interno e externo a partir do ponto da curva e da sua derivada
+void TrackEditor::calcularBordas(vec2 current, vec2 derivada, vec2& innerPoint, vec2& outerPoint) {
+    // Calcula vetor perpendicular a partir da derivada analítica da amostra
+    vec2 perpendicular = calcularPerpendicular(derivada);
+    
+    // Calcula a largura da pista (metade para cada lado)
+    float halfWidth = larguraAtual / 2.0f;
+    
+    // Calcula pontos interno e externo
+    innerPoint = current - perpendicular * halfWidth;
+    outerPoint = current + perpendicular * halfWidth;
+}
+
+// Calcula os pontos interno e externo da amostra i da B-Spline
+void TrackEditor::calcularBordasAmostra(int i) {
+    calcularBordas(bSplinePoints[i], bSplineDerivadas[i], innerCurve[i], outerCurve[i]);
+}
+
+// Calcula as curvas interna e externa da pista
+void TrackEditor::calcularCurvasInternaExterna(float trackWidth) {
+    PERFIL_ZONA("TrackEditor::calcularCurvasInternaExterna");
+    innerCurve.clear();
+    outerCurve.clear();
+    marcarCurvasAlteradas();
+    
+    int numPoints = bSplinePoints.size();
+    if (numPoints < 2 || bSplineDerivadas.size() != size_t(numPoints)) {
+        cout << "Necessario gerar B-Spline antes de calcular curvas interna/externa" << endl;
+        return;
+    }
+    
+    larguraAtual = trackWidth;
+    redimensionarSaida(innerCurve, numPoints);
+    redimensionarSaida(outerCurve, numPoints);
+    
+    // Para cada ponto da B-Spline (amostras independentes, em blocos paralelos)
+    ThreadPool::global().paraCada(numPoints, AMOSTRAS_POR_BLOCO, [&](int inicio, int fim) {
+        for (int i = inicio; i < fim; i++) {
+            calcularBordasAmostra(i);
+        }
+    });
+    
+    cout << "Curvas interna e externa calculadas com " << innerCurve.size() << " pontos cada" << endl;
+    
+    trechosCorrigidos.clear();
+    if (correcaoAutoIntersecao) corrigirAutoIntersecoes();
+}
+
+// Interseção própria entre os segmentos (a, b) e (c, d); retorna o ponto em 'ponto'
+static bool intersectarSegmentos(vec2 a, vec2 b, vec2 c, vec2 d, vec2& ponto) {
+    vec2 r = b - a;
+    vec2 s = d - c;
+    float denom = r.x * s.y - r.y * s.x;
+    if (fabs(denom) < 1e-12f) return false;  // Paralelos
+    
+    vec2 ac = c - a;
+    float t = (ac.x * s.y - ac.y * s.x) / denom;
+    float u = (ac.x * r.y - ac.y * r.x) / denom;
+    if (t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f) return false;
+    
+    ponto = a + t * r;
+    return true;
+}
+
+// Encontra e colapsa os laços locais de uma borda fechada, ou só do trecho de 'quantidade'
+// amostras a partir de 'inicio' (aberto; pode dar a volta no fim da borda).
+// Fase larga: grade uniforme; cada segmento é dividido em pedaços do tamanho da célula e
+// registrado nas células que eles tocam; as células vão para baldes por hash, agrupados
+// com ordenação por contagem, então a busca toda é O(n). Um laço é o trecho mais curto
+// entre dois segmentos que se cruzam; só laços com perímetro até 2π·largura são tratados
+// como dobras locais (os cruzamentos da pista consigo mesma, como no "8", são bem maiores
+// e ficam intactos). O perímetro sai de uma soma de prefixos dos comprimentos, em O(1)
+// por par, e pares não locais são descartados antes do teste de interseção.
+// Os pontos do laço são movidos para o ponto de interseção, então a quantidade de
+// amostras (e a topologia da malha) não muda: os triângulos do laço ficam degenerados
+// em vez de invertidos.
+void TrackEditor::corrigirLacosCurva(vec2* curva, int numPoints, bool interna, int inicio, int quantidade) {
+    if (numPoints < 4 || quantidade < 4) return;
+    
+    EscopoRascunho escopo(*this);
+    pmr::memory_resource* arena = rascunho.recurso();
+    
+    // Índices locais do trecho; a borda inteira é fechada, um trecho é aberto
+    bool fechada = quantidade >= numPoints;
+    int m = fechada ? numPoints : quantidade;
+    int numSegmentos = fechada ? m : m - 1;
+    auto ponto = [&](int l) -> vec2& { return curva[(inicio + l % m) % numPoints]; };
+    
+    // Comprimento acumulado do trecho (acumulado[l] = soma dos segmentos antes de l);
+    // tamanho da célula: comprimento médio dos segmentos
+    pmr::vector<double> acumulado(numSegmentos + 1, 0.0, arena);
+    for (int l = 0; l < numSegmentos; l++) {
+        acumulado[l + 1] = acumulado[l] + length(ponto(l + 1) - ponto(l));
+    }
+    double somaComprimentos = acumulado[numSegmentos];
+    float celula = std::max(float(somaComprimentos / numSegmentos), 1e-6f);
+    double perimetroMaximo = 2.0 * 3.14159265 * larguraAtual;
+    
+    // Faixas de comprimento de arco com largura >= perimetroMaximo: os dois segmentos de
+    // um laço local estão na mesma faixa ou em faixas vizinhas (circularmente, na borda
+    // fechada). Cada segmento entra na sua faixa e na seguinte, então só esses pares se
+    // encontram nos baldes; em bordas muito longas e emaranhadas isso evita testar pares distantes.
+    int numFaixas = int(somaComprimentos / std::max(perimetroMaximo, 1e-6));
+    if (numFaixas < 3) numFaixas = 1;
+    double larguraFaixa = somaComprimentos / numFaixas;
+    
+    // Células espalhadas por hash em baldes (potência de 2); colisões só geram testes a mais
+    uint32_t numBaldes = 1;
+    while (numBaldes < uint32_t(m) * 2) numBaldes <<= 1;
+    auto baldeCelula = [numBaldes](int cx, int cy, int faixa) {
+        uint32_t h = uint32_t(cx) * 73856093u ^ uint32_t(cy) * 19349663u ^ uint32_t(faixa) * 83492791u;
+        return h & (numBaldes - 1);
+    };
+    
+    // Pares (balde, segmento); pedaços consecutivos do mesmo segmento repetem células
+    pmr::vector<pair<uint32_t, int>> entradas(arena);
+    entradas.reserve(size_t(numSegmentos) * (numFaixas > 1 ? 6 : 3));
+    for (int i = 0; i < numSegmentos; i++) {
+        vec2 a = ponto(i);
+        vec2 b = ponto(i + 1);
+        int pedacos = std::max(1, int(ceil(length(b - a) / celula)));
+        int faixa = std::min(int(acumulado[i] / larguraFaixa), numFaixas - 1);
+        int faixas[2] = { faixa, (faixa + 1) % numFaixas };
+        int quantidadeFaixas = (numFaixas > 1 && (fechada || faixa + 1 < numFaixas)) ? 2 : 1;
+        uint32_t recentes[8] = { ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u };
+        int proximo = 0;
+        for (int k = 0; k < pedacos; k++) {
+            vec2 p0 = mix(a, b, float(k) / pedacos);
+            vec2 p1 = mix(a, b, float(k + 1) / pedacos);
+            // Um pedaço menor que a célula toca no máximo 2x2 células
+            vec2 minimo = glm::min(p0, p1), maximo = glm::max(p0, p1);
+            int x0 = int(floor(minimo.x / celula)), x1 = int(floor(maximo.x / celula));
+            int y0 = int(floor(minimo.y / celula)), y1 = int(floor(maximo.y / celula));
+            for (int f = 0; f < quantidadeFaixas; f++) {
+                for (int cx = x0; cx <= x1; cx++) {
+                    for (int cy = y0; cy <= y1; cy++) {
+                        uint32_t balde = baldeCelula(cx, cy, faixas[f]);
+                        if (find(recentes, recentes + 8, balde) != recentes + 8) continue;
+                        recentes[proximo] = balde;
+                        proximo = (proximo + 1) & 7;
+                        entradas.push_back({ balde, i });
+                    }
+                }
+            }
+        }
+    }
+    
+    // Ordenação por contagem dos segmentos por balde: O(n)
+    pmr::vector<int> inicioBalde(numBaldes + 1, 0, arena);
+    for (const auto& e : entradas) inicioBalde[e.first + 1]++;
+    for (uint32_t k = 0; k < numBaldes; k++) inicioBalde[k + 1] += inicioBalde[k];
+    pmr::vector<int> segmentosBalde(entradas.size(), arena);
+    {
+        pmr::vector<int> escrita(inicioBalde.begin(), inicioBalde.end() - 1, arena);
+        for (const auto& e : entradas) segmentosBalde[escrita[e.first]++] = e.second;
+    }
+    
+    // Fase estreita: pares de segmentos não adjacentes do mesmo balde. O laço de cada
+    // cruzamento é o trecho mais curto (em amostras) entre os dois segmentos; no trecho
+    // aberto, o de dentro.
+    struct Laco { int inicio, quantidade; vec2 ponto; };
+    pmr::vector<Laco> lacos(arena);
+    for (uint32_t balde = 0; balde < numBaldes; balde++) {
+        int a = inicioBalde[balde];
+        int b = inicioBalde[balde + 1];
+        
+        for (int x = a; x < b; x++) {
+            for (int y = x + 1; y < b; y++) {
+                int i = segmentosBalde[x];
+                int j = segmentosBalde[y];
+                if (j - i <= 1 || (fechada && i == 0 && j == m - 1)) continue;  // Mesmo ou adjacentes
+                
+                // Laço candidato antes do teste de interseção: pares distantes ao longo da
+                // borda não formam laço local e são descartados sem calcular nada
+                int dentro = j - i;                       // Amostras i+1..j
+                int fora = fechada ? m - dentro : m;      // Amostras j+1..i (dando a volta)
+                double arcoDentro = acumulado[j] - acumulado[i];
+                double perimetro = (dentro <= fora) ? arcoDentro : somaComprimentos - arcoDentro;
+                if (perimetro > perimetroMaximo) continue;
+                
+                vec2 intersecao;
+                if (!intersectarSegmentos(ponto(i), ponto(i + 1), ponto(j), ponto(j + 1), intersecao)) continue;
+                
+                lacos.push_back((dentro <= fora) ? Laco{ i + 1, dentro, intersecao }
+                                                 : Laco{ (j + 1) % m, fora, intersecao });
+            }
+        }
+    }
+    
+    // Laços maiores primeiro: um laço dentro de outro já colapsado é ignorado
+    // (o mesmo par pode aparecer em mais de um balde: repetidos ficam vizinhos e são removidos)
+    sort(lacos.begin(), lacos.end(), [](const Laco& x, const Laco& y) {
+        return x.quantidade != y.quantidade ? x.quantidade > y.quantidade : x.inicio < y.inicio;
+    });
+    lacos.erase(unique(lacos.begin(), lacos.end(), [](const Laco& x, const Laco& y) {
+        return x.inicio == y.inicio && x.quantidade == y.quantidade;
+    }), lacos.end());
+    pmr::vector<char> colapsada(m, 0, arena);
+    for (const auto& laco : lacos) {
+        bool livre = true;
+        for (int k = 0; k < laco.quantidade && livre; k++) {
+            livre = !colapsada[(laco.inicio + k) % m];
+        }
+        if (!livre) continue;
+        
+        for (int k = 0; k < laco.quantidade; k++) {
+            int l = (laco.inicio + k) % m;
+            ponto(l) = laco.ponto;
+            colapsada[l] = 1;
+        }
+        trechosCorrigidos.push_back({ interna, (inicio + laco.inicio) % numPoints, laco.quantidade });
+    }
+}
+
+// Corrige as dobras das curvas interna e externa (raio da curva menor que meia largura)
+int TrackEditor::corrigirAutoIntersecoes() {
+    PERFIL_ZONA("TrackEditor::corrigirAutoIntersecoes");
+    trechosCorrigidos.clear();
+    if (innerCurve.size() != bSplinePoints.size() || outerCurve.size() != innerCurve.size()) return 0;
+    
+    int numPoints = innerCurve.size();
+    corrigirLacosCurva(innerCurve.data(), numPoints, true, 0, numPoints);
+    corrigirLacosCurva(outerCurve.data(), numPoints, false, 0, numPoints);
+    for (const auto& t : trechosCorrigidos) marcarAmostrasAlteradas(t.inicio, t.quantidade);
+    return trechosCorrigidos.size();
+}
+
+// Correção incremental dos laços depois de uma edição (bordas dos segmentos pendentes já
+// recalculadas). Um laço tem no máximo 2π·largura de perímetro, então só pode envolver
+// amostras até essa distância, ao longo da borda, das amostras alteradas: a janela de
+// cada borda é esse entorno mais os trechos colapsados antes que caem nele, que são
+// restaurados e corrigidos de novo. Os trechos fora da janela continuam como estão.
+// Custo proporcional à janela, não à borda. Os trechos restaurados e os novos vão para
+// trechosRegravar e são marcados como alterados.
+void TrackEditor::corrigirLacosAlterados() {
+    int numPoints = bSplinePoints.size();
+    trechosRegravar.clear();
+    
+    auto restaurar = [&](const TrechoCorrigido& t) {
+        vector<vec2>& curva = t.interna ? innerCurve : outerCurve;
+        for (int k = 0; k < t.quantidade; k++) {
+            int p = (t.inicio + k) % numPoints;
+            vec2 innerPoint, outerPoint;
+            calcularBordas(bSplinePoints[p], bSplineDerivadas[p], innerPoint, outerPoint);
+            curva[p] = t.interna ? innerPoint : outerPoint;
+        }
+        marcarAmostrasAlteradas(t.inicio, t.quantidade);
+        trechosRegravar.push_back(t);
+    };
+    
+    // Correção desligada: só desfaz os trechos antigos
+    if (!correcaoAutoIntersecao) {
+        for (const auto& t : trechosCorrigidos) restaurar(t);
+        trechosCorrigidos.clear();
+        return;
+    }
+    
+    EscopoRascunho escopo(*this);
+    pmr::memory_resource* arena = rascunho.recurso();
+    double perimetroMaximo = 2.0 * 3.14159265 * larguraAtual;
+    
+    // Amostras alteradas: segmentos pendentes consecutivos viram um intervalo só
+    pmr::vector<int> segmentos(segmentosPendentes.begin(), segmentosPendentes.end(), arena);
+    sort(segmentos.begin(), segmentos.end());
+    struct Intervalo { int inicio, fim; };      // [inicio, fim) em 0..numPoints
+    pmr::vector<Intervalo> alteradas(arena);
+    for (int s : segmentos) {
+        if (!alteradas.empty() && alteradas.back().fim == inicioSegmento[s]) {
+            alteradas.back().fim = inicioSegmento[s + 1];
+        } else {
+            alteradas.push_back({ inicioSegmento[s], inicioSegmento[s + 1] });
+        }
+    }
+    
+    // Intervalos circulares (podem dar a volta) guardados como lineares, ordenados e unidos
+    pmr::vector<Intervalo> janela(arena);
+    auto acrescentar = [&](int inicio, int quantidade) {
+        if (quantidade >= numPoints) {
+            janela.push_back({ 0, numPoints });
+            return;
+        }
+        inicio = (inicio % numPoints + numPoints) % numPoints;
+        if (inicio + quantidade > numPoints) {
+            janela.push_back({ inicio, numPoints });
+            janela.push_back({ 0, inicio + quantidade - numPoints });
+        } else {
+            janela.push_back({ inicio, inicio + quantidade });
+        }
+    };
+    auto unir = [&]() {
+        sort(janela.begin(), janela.end(), [](const Intervalo& a, const Intervalo& b) { return a.inicio < b.inicio; });
+        size_t saida = 0;
+        for (size_t k = 0; k < janela.size(); k++) {
+            if (saida > 0 && janela[k].inicio <= janela[saida - 1].fim) {
+                janela[saida - 1].fim = std::max(janela[saida - 1].fim, janela[k].fim);
+            } else {
+                janela[saida++] = janela[k];
+            }
+        }
+        janela.resize(saida);
+    };
+    auto tocaJanela = [&](int inicio, int quantidade) {
+        inicio = (inicio % numPoints + numPoints) % numPoints;
+        for (const auto& j : janela) {
+            if (quantidade >= numPoints || (inicio < j.fim && inicio + quantidade > j.inicio) ||
+                (inicio + quantidade > numPoints && j.inicio < inicio + quantidade - numPoints)) return true;
+        }
+        return false;
+    };
+    
+    // Os trechos novos entram em trechosCorrigidos; os antigos mantidos voltam no fim
+    pmr::vector<TrechoCorrigido> antigos(trechosCorrigidos.begin(), trechosCorrigidos.end(), arena);
+    trechosCorrigidos.clear();
+    for (int lado = 0; lado < 2; lado++) {
+        bool interna = lado == 0;
+        vector<vec2>& curva = interna ? innerCurve : outerCurve;
+        
+        // Entorno de perímetroMaximo (e mais um segmento) antes e depois de cada intervalo
+        janela.clear();
+        for (const auto& a : alteradas) {
+            int antes = 0, depois = 0;
+            double arco = 0.0;
+            while (arco <= perimetroMaximo && antes < numPoints) {
+                int p = ((a.inicio - antes) % numPoints + numPoints) % numPoints;
+                arco += length(curva[p] - curva[(p - 1 + numPoints) % numPoints]);
+                antes++;
+            }
+            arco = 0.0;
+            while (arco <= perimetroMaximo && depois < numPoints) {
+                int p = (a.fim - 1 + depois) % numPoints;
+                arco += length(curva[(p + 1) % numPoints] - curva[p]);
+                depois++;
+            }
+            acrescentar(a.inicio - antes - 1, a.fim - a.inicio + antes + depois + 2);
+        }
+        unir();
+        
+        // Trechos antigos desta borda que tocam a janela (com os segmentos que se cruzavam):
+        // restaurados e incluídos nela, até não sobrar nenhum
+        bool mudou = true;
+        while (mudou) {
+            mudou = false;
+            for (size_t k = 0; k < antigos.size(); k++) {
+                TrechoCorrigido t = antigos[k];
+                if (t.interna != interna || !tocaJanela(t.inicio - 1, t.quantidade + 2)) continue;
+                restaurar(t);
+                acrescentar(t.inicio - 1, t.quantidade + 2);
+                antigos.erase(antigos.begin() + k--);
+                mudou = true;
+            }
+            if (mudou) unir();
+        }
+        
+        // Os pedaços em 0 e em numPoints são o mesmo trecho circular
+        if (janela.size() > 1 && janela.front().inicio == 0 && janela.back().fim == numPoints) {
+            janela.front().inicio = janela.back().inicio - numPoints;
+            janela.pop_back();
+        }
+        for (const auto& j : janela) {
+            corrigirLacosCurva(curva.data(), numPoints, interna, (j.inicio + numPoints) % numPoints, j.fim - j.inicio);
+        }
+    }
+    
+    for (const auto& t : trechosCorrigidos) {
+        marcarAmostrasAlteradas(t.inicio, t.quantidade);
+        trechosRegravar.push_back(t);
+    }
+    trechosCorrigidos.insert(trechosCorrigidos.end(), antigos.begin(), antigos.end());
+}
+
+// Teste de eixo separador (SAT) entre dois triângulos 2D: true se os interiores se
+// sobrepõem. Encostar em uma aresta não conta; triângulos degenerados nunca se sobrepõem.
+static bool triangulosSobrepostos(const vec2* a, const vec2* b) {
+    const vec2* triangulos[2] = { a, b };
+    for (const vec2* tri : triangulos) {
+        for (int k = 0; k < 3; k++) {
+            vec2 aresta = tri[(k + 1) % 3] - tri[k];
+            vec2 eixo(-aresta.y, aresta.x);
+            
+            float minA = dot(eixo, a[0]), maxA = minA;
+            float minB = dot(eixo, b[0]), maxB = minB;
+            for (int v = 1; v < 3; v++) {
+                float pa = dot(eixo, a[v]);
+                float pb = dot(eixo, b[v]);
+                minA = std::min(minA, pa); maxA = std::max(maxA, pa);
+                minB = std::min(minB, pb); maxB = std::max(maxB, pb);
+            }
+            if (maxA <= minB || maxB <= minA) return false;
+        }
+    }
+    return true;
 }
 
-// Função de base B-Spline (base de Cox-de Boor)
-float TrackEditor::baseBSpline(int i, int k, float t) {
-    // Para B-Spline uniforme de grau 3 (cúbica)
-    // Implementação simplificada para curva fechada
+// Comprimento acumulado do eixo da malha em faixa (ponto médio dos dois vértices de cada
+// amostra); N + 1 valores, o último é o comprimento total
+void TrackEditor::calcularDistanciasMalha(pmr::vector<double>& distancia) const {
+    int numPoints = vertices.size() / 2;
+    distancia.assign(numPoints + 1, 0.0);
     
-    if (k == 0) {
-        return (t >= i && t < i + 1) ? 1.0f : 0.0f;
+    auto centro = [&](int i) {
+        return 0.5f * (vec2(vertices[i * 2].position) + vec2(vertices[i * 2 + 1].position));
+    };
+    for (int i = 0; i < numPoints; i++) {
+        distancia[i + 1] = distancia[i] + length(centro((i + 1) % numPoints) - centro(i));
     }
+}
+
+// Detecta os trechos da pista que passam por cima de outros trechos distantes.
+// Sementes: dois ramos que se cruzam cruzam as bordas um do outro, então basta procurar
+// os cruzamentos entre os segmentos das bordas (de uma amostra à seguinte). Eles são
+// registrados em uma grade com células do tamanho do espaçamento das amostras, espalhadas
+// por hash em baldes e agrupadas por ordenação por contagem; cada balde tem poucos
+// segmentos, então a busca é O(n) esperado. Pares a menos de 2π·largura um do outro ao
+// longo da pista não contam (é a própria curva, já tratada por corrigirAutoIntersecoes).
+// Cada semente fora dos cruzamentos já encontrados é estendida percorrendo o ramo A nos
+// dois sentidos: o intervalo de quads de B sobrepostos a cada quad de A (teste SAT) sai
+// do intervalo do quad anterior, ajustando só as pontas, em vez de testar todos os pares
+// da região sobreposta. O ponto do cruzamento é a média dos centros dos pares, somada por
+// intervalo com somas de prefixos.
+int TrackEditor::detectarCruzamentos() {
+    PERFIL_ZONA("TrackEditor::detectarCruzamentos");
+    cruzamentosPista.clear();
     
-    float c1 = 0.0f, c2 = 0.0f;
+    int numPoints = vertices.size() / 2;
+    if (!malhaEmFaixa || numPoints < 4 || triangles.size() != vertices.size()) return 0;
     
-    float denom1 = k;
-    if (denom1 != 0.0f) {
-        c1 = (t - i) / denom1;
-    }
+    EscopoRascunho escopo(*this);
+    pmr::memory_resource* arena = rascunho.recurso();
     
-    float denom2 = k;
-    if (denom2 != 0.0f) {
-        c2 = (i + k + 1 - t) / denom2;
-    }
+    pmr::vector<double> distancia(arena);
+    calcularDistanciasMalha(distancia);
+    double total = distancia[numPoints];
+    double distanciaMinima = 2.0 * 3.14159265 * larguraAtual;
     
-    return c1 * baseBSpline(i, k - 1, t) + c2 * baseBSpline(i + 1, k - 1, t);
-}
-
-// Avalia a curva B-Spline no parâmetro t
-vec2 TrackEditor::avaliarBSpline(float t, int i) {
-    int n = pontosDeControle.size();
-    if (n < 4) return vec2(0, 0);  // Precisa de pelo menos 4 pontos
+    auto indice = [numPoints](int i) { return (i % numPoints + numPoints) % numPoints; };
+    // Ponto da borda (0 = interna, 1 = externa) na amostra i
+    auto borda = [&](int lado, int i) { return vec2(vertices[indice(i) * 2 + lado].position); };
     
-    // B-Spline cúbica uniforme
-    float u = t - floor(t);
+    // Quads longe o bastante um do outro ao longo da pista, nos dois sentidos
+    auto distantes = [&](int i, int j) {
+        double d = fabs(distancia[indice(i)] - distancia[indice(j)]);
+        return d > distanciaMinima && total - d > distanciaMinima;
+    };
     
-    // Matriz de base B-Spline cúbica
-    float b0 = (1 - u) * (1 - u) * (1 - u) / 6.0f;
-    float b1 = (3 * u * u * u - 6 * u * u + 4) / 6.0f;
-    float b2 = (-3 * u * u * u + 3 * u * u + 3 * u + 1) / 6.0f;
-    float b3 = u * u * u / 6.0f;
+    // Triângulos do quad i no plano
+    auto triangulosQuad = [&](int i, vec2* saida) {
+        for (int t = 0; t < 2; t++) {
+            const Triangle& tri = triangles[i * 2 + t];
+            saida[t * 3 + 0] = vec2(vertices[tri.v1].position);
+            saida[t * 3 + 1] = vec2(vertices[tri.v2].position);
+            saida[t * 3 + 2] = vec2(vertices[tri.v3].position);
+        }
+    };
     
-    // Índices com wraparound para curva fechada
-    int i0 = i % n;
-    int i1 = (i + 1) % n;
-    int i2 = (i + 2) % n;
-    int i3 = (i + 3) % n;
+    // Quads distantes com os interiores sobrepostos: caixas primeiro, depois SAT
+    auto sobrepostos = [&](int i, int j) {
+        i = indice(i);
+        j = indice(j);
+        if (!distantes(i, j)) return false;
+        
+        vec2 ti[6], tj[6];
+        triangulosQuad(i, ti);
+        triangulosQuad(j, tj);
+        vec2 minimoI = ti[0], maximoI = ti[0], minimoJ = tj[0], maximoJ = tj[0];
+        for (int v = 1; v < 6; v++) {
+            minimoI = glm::min(minimoI, ti[v]); maximoI = glm::max(maximoI, ti[v]);
+            minimoJ = glm::min(minimoJ, tj[v]); maximoJ = glm::max(maximoJ, tj[v]);
+        }
+        if (maximoI.x <= minimoJ.x || maximoJ.x <= minimoI.x || maximoI.y <= minimoJ.y || maximoJ.y <= minimoI.y) return false;
+        
+        return triangulosSobrepostos(ti, tj) || triangulosSobrepostos(ti, tj + 3) ||
+               triangulosSobrepostos(ti + 3, tj) || triangulosSobrepostos(ti + 3, tj + 3);
+    };
     
-    vec2 point = b0 * pontosDeControle[i0] +
-                 b1 * pontosDeControle[i1] +
-                 b2 * pontosDeControle[i2] +
-                 b3 * pontosDeControle[i3];
+    // Tamanho da célula: comprimento médio dos segmentos das bordas
+    double somaComprimentos = 0.0;
+    for (int i = 0; i < numPoints; i++) {
+        for (int lado = 0; lado < 2; lado++) somaComprimentos += length(borda(lado, i + 1) - borda(lado, i));
+    }
+    float celula = std::max(float(somaComprimentos / (2 * numPoints)), 1e-6f);
     
-    return point;
-}
-
-void TrackEditor::gerarBSpline(int resolution) {
-    bSplinePoints.clear();
+    uint32_t numBaldes = 1;
+    while (numBaldes < uint32_t(numPoints) * 4) numBaldes <<= 1;
     
-    int n = pontosDeControle.size();
-    if (n < 4) {
-        cout << "Necessario pelo menos 4 pontos de controle para gerar B-Spline" << endl;
-        return;
+    // Pares (balde, segmento), segmento = quad * 2 + lado; pedaços consecutivos do mesmo
+    // segmento repetem células
+    pmr::vector<pair<uint32_t, int>> entradas(arena);
+    entradas.reserve(size_t(numPoints) * 6);
+    for (int i = 0; i < numPoints; i++) {
+        for (int lado = 0; lado < 2; lado++) {
+            vec2 a = borda(lado, i);
+            vec2 b = borda(lado, i + 1);
+            int pedacos = std::max(1, int(ceil(length(b - a) / celula)));
+            uint32_t recentes[4] = { ~0u, ~0u, ~0u, ~0u };
+            int proximo = 0;
+            for (int k = 0; k < pedacos; k++) {
+                vec2 p0 = mix(a, b, float(k) / pedacos);
+                vec2 p1 = mix(a, b, float(k + 1) / pedacos);
+                vec2 minimo = glm::min(p0, p1), maximo = glm::max(p0, p1);
+                int x0 = int(floor(minimo.x / celula)), x1 = int(floor(maximo.x / celula));
+                int y0 = int(floor(minimo.y / celula)), y1 = int(floor(maximo.y / celula));
+                for (int cx = x0; cx <= x1; cx++) {
+                    for (int cy = y0; cy <= y1; cy++) {
+                        uint32_t balde = (uint32_t(cx) * 73856093u ^ uint32_t(cy) * 19349663u) & (numBaldes - 1);
+                        if (find(recentes, recentes + 4, balde) != recentes + 4) continue;
+                        recentes[proximo] = balde;
+                        proximo = (proximo + 1) & 3;
+                        entradas.push_back({ balde, i * 2 + lado });
+                    }
+                }
+            }
+        }
     }
     
-    // Gera pontos ao longo da curva B-Spline fechada
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < resolution; j++) {
-            float t = float(j) / float(resolution);
-            vec2 point = avaliarBSpline(i + t, i);
-            bSplinePoints.push_back(point);
+    pmr::vector<int> inicioBalde(numBaldes + 1, 0, arena);
+    for (const auto& e : entradas) inicioBalde[e.first + 1]++;
+    for (uint32_t k = 0; k < numBaldes; k++) inicioBalde[k + 1] += inicioBalde[k];
+    pmr::vector<int> segmentosBalde(entradas.size(), arena);
+    {
+        pmr::vector<int> escrita(inicioBalde.begin(), inicioBalde.end() - 1, arena);
+        for (const auto& e : entradas) segmentosBalde[escrita[e.first]++] = e.second;
+    }
+    
+    // Cada balde está em ordem crescente de quad (a ordenação por contagem é estável), então
+    // a distância ao longo da pista cresce com y: os pares longe o bastante de x formam uma
+    // faixa contínua [perto, longe), achada com dois ponteiros que só avançam (nos laços
+    // colapsados muitos segmentos caem no mesmo balde, todos perto uns dos outros)
+    pmr::vector<pair<int, int>> sementes(arena);
+    for (uint32_t balde = 0; balde < numBaldes; balde++) {
+        int fimBalde = inicioBalde[balde + 1];
+        int perto = inicioBalde[balde], longe = inicioBalde[balde];
+        for (int x = inicioBalde[balde]; x < fimBalde; x++) {
+            int i = segmentosBalde[x] / 2;
+            perto = std::max(perto, x + 1);
+            while (perto < fimBalde && distancia[segmentosBalde[perto] / 2] - distancia[i] <= distanciaMinima) perto++;
+            longe = std::max(longe, perto);
+            while (longe < fimBalde && total - (distancia[segmentosBalde[longe] / 2] - distancia[i]) > distanciaMinima) longe++;
+            
+            for (int y = perto; y < longe; y++) {
+                int ladoI = segmentosBalde[x] % 2, ladoJ = segmentosBalde[y] % 2;
+                int j = segmentosBalde[y] / 2;
+                vec2 ponto;
+                if (intersectarSegmentos(borda(ladoI, i), borda(ladoI, i + 1),
+                                         borda(ladoJ, j), borda(ladoJ, j + 1), ponto)) {
+                    sementes.push_back({ i, j });
+                }
+            }
         }
     }
+    if (sementes.empty()) return 0;
+    sort(sementes.begin(), sementes.end());
+    sementes.erase(unique(sementes.begin(), sementes.end()), sementes.end());
     
-    cout << "B-Spline gerada com " << bSplinePoints.size() << " pontos" << endl;
+    // Soma dos centros das amostras lo..hi (índices podem passar das pontas da pista)
+    pmr::vector<dvec2> prefixoCentros(numPoints + 1, dvec2(0.0), arena);
+    for (int i = 0; i < numPoints; i++) {
+        prefixoCentros[i + 1] = prefixoCentros[i] + dvec2(0.5f * (borda(0, i) + borda(1, i)));
+    }
+    auto somaCentros = [&](int lo, int hi) {
+        int inicio = indice(lo), fim = inicio + hi - lo + 1;
+        if (fim <= numPoints) return prefixoCentros[fim] - prefixoCentros[inicio];
+        return prefixoCentros[numPoints] - prefixoCentros[inicio] + prefixoCentros[fim - numPoints];
+    };
+    
+    // Intervalo [lo, hi] de quads de B sobrepostos ao quad a, a partir do intervalo do quad
+    // vizinho de A: as pontas só andam o quanto o intervalo mudou; false se ficou vazio
+    auto ajustarIntervalo = [&](int a, int& lo, int& hi) {
+        while (lo <= hi && !sobrepostos(a, lo)) lo++;
+        while (hi >= lo && !sobrepostos(a, hi)) hi--;
+        if (lo > hi) return false;
+        while (hi - lo + 1 < numPoints && sobrepostos(a, lo - 1)) lo--;
+        while (hi - lo + 1 < numPoints && sobrepostos(a, hi + 1)) hi++;
+        return true;
+    };
+    auto contem = [&](int inicio, int quantidade, int i) {
+        return (i - inicio + numPoints) % numPoints < quantidade;
+    };
+    
+    for (const auto& semente : sementes) {
+        int i = semente.first, j = semente.second;
+        bool conhecida = false;
+        for (const auto& c : cruzamentosPista) {
+            conhecida = conhecida ||
+                (contem(c.inicioA, c.quantidadeA, i) && contem(c.inicioB, c.quantidadeB, j)) ||
+                (contem(c.inicioA, c.quantidadeA, j) && contem(c.inicioB, c.quantidadeB, i));
+        }
+        if (conhecida) continue;
+        
+        int loSemente = j, hiSemente = j;
+        if (!ajustarIntervalo(i, loSemente, hiSemente)) continue;   // Bordas só se encostam
+        
+        int a0 = i, a1 = i, b0 = loSemente, b1 = hiSemente;
+        dvec2 soma(0.0);
+        long long quantidade = 0;
+        auto acumular = [&](int a, int lo, int hi) {
+            soma += double(hi - lo + 1) * dvec2(0.5f * (borda(0, a) + borda(1, a))) + somaCentros(lo, hi);
+            quantidade += hi - lo + 1;
+            b0 = std::min(b0, lo);
+            b1 = std::max(b1, hi);
+        };
+        acumular(i, loSemente, hiSemente);
+        
+        for (int sentido : { 1, -1 }) {
+            int lo = loSemente, hi = hiSemente;
+            for (int a = i + sentido; a1 - a0 + 1 < numPoints && ajustarIntervalo(a, lo, hi); a += sentido) {
+                acumular(a, lo, hi);
+                a0 = std::min(a0, a);
+                a1 = std::max(a1, a);
+            }
+        }
+        
+        cruzamentosPista.push_back({ indice(a0), a1 - a0 + 1, indice(b0), std::min(b1 - b0 + 1, numPoints),
+                                     vec2(soma * 0.5 / double(quantidade)) });
+    }
+    
+    return cruzamentosPista.size();
+}
+
+// Fim de um arraste: a detecção de cruzamentos percorre a malha inteira, então fica fora
+// das atualizações de cada movimento
+void TrackEditor::concluirEdicao() {
+    atualizarTrechosAlterados();
+    if (pontesPendentes && malhaEmFaixa && !vertices.empty()) aplicarPontes();
 }
 
-// Calcula o vetor perpendicular normalizado
-vec2 TrackEditor::calcularPerpendicular(vec2 p1, vec2 p2) {
-    vec2 tangent = p2 - p1;
+// Liga/desliga as pontes automáticas; aplica na malha atual, se houver
+void TrackEditor::definirPontes(bool ativo, float altura, float rampa) {
+    pontesAutomaticas = ativo;
+    alturaPonte = altura;
+    comprimentoRampa = std::max(rampa, 0.0f);
     
-    // Normaliza o vetor tangente
-    float length = sqrt(tangent.x * tangent.x + tangent.y * tangent.y);
-    if (length > 0.0001f) {
-        tangent /= length;
+    if (malhaEmFaixa && !vertices.empty()) aplicarPontes();
+}
+
+// Eleva o ramo B de cada cruzamento: platô sobre o trecho sobreposto (com meia largura de
+// folga em cada lado) e rampas suavizadas (smoothstep) até a altura zero. Cada rampa é
+// encurtada quando necessário para terminar antes do ramo A, que fica sempre no chão.
+// Sem pontes automáticas, devolve a malha ao plano Z = 0.
+void TrackEditor::aplicarPontes() {
+    PERFIL_ZONA("TrackEditor::aplicarPontes");
+    pontesPendentes = false;
+    int numPoints = vertices.size() / 2;
+    if (!malhaEmFaixa || numPoints < 4) return;
+    
+    EscopoRascunho escopo(*this);
+    reservarComFolga(alturasAmostras, numPoints);
+    alturasAmostras.assign(numPoints, 0.0f);
+    if (pontesAutomaticas) {
+        detectarCruzamentos();
+        
+        pmr::vector<double> distancia(rascunho.recurso());
+        calcularDistanciasMalha(distancia);
+        double total = distancia[numPoints];
+        double margem = larguraAtual * 0.5;
+        
+        // Fator de altura a uma distância d do platô, para uma rampa de comprimento dado
+        auto perfil = [](double d, double rampa) {
+            if (rampa <= 0.0 || d >= rampa) return 0.0;
+            double t = d / rampa;
+            return 1.0 - t * t * (3.0 - 2.0 * t);
+        };
+        // Distância de 'de' até 'ate' seguindo o sentido da pista
+        auto adiante = [total](double de, double ate) {
+            return fmod(ate - de + 2.0 * total, total);
+        };
+        
+        for (const auto& c : cruzamentosPista) {
+            int fimA = (c.inicioA + c.quantidadeA) % numPoints;
+            int fimB = (c.inicioB + c.quantidadeB) % numPoints;
+            double inicioPlato = distancia[c.inicioB] - margem;
+            double plato = adiante(distancia[c.inicioB], distancia[fimB]) + 2.0 * margem;
+            
+            double rampaDepois = std::max(0.0, std::min(double(comprimentoRampa),
+                                          adiante(inicioPlato + plato, distancia[c.inicioA]) - margem));
+            double rampaAntes = std::max(0.0, std::min(double(comprimentoRampa),
+                                         adiante(distancia[fimA], inicioPlato) - margem));
+            
+            // Fator da amostra k; zero fora do trecho rampa + platô + rampa
+            auto fatorAmostra = [&](int k) {
+                double o = adiante(inicioPlato, distancia[k]);
+                return (o <= plato) ? 1.0 : std::max(perfil(o - plato, rampaDepois),
+                                                     perfil(total - o, rampaAntes));
+            };
+            
+            // Percorre só esse trecho, a partir do início do ramo B nos dois sentidos, em vez
+            // da pista inteira para cada cruzamento
+            int visitadas = 0;
+            for (int k = c.inicioB; visitadas < numPoints; k = (k + 1) % numPoints, visitadas++) {
+                double fator = fatorAmostra(k);
+                if (fator <= 0.0) break;
+                alturasAmostras[k] = std::max(alturasAmostras[k], float(alturaPonte * fator));
+            }
+            for (int k = (c.inicioB - 1 + numPoints) % numPoints; visitadas < numPoints;
+                 k = (k - 1 + numPoints) % numPoints, visitadas++) {
+                double fator = fatorAmostra(k);
+                if (fator <= 0.0) break;
+                alturasAmostras[k] = std::max(alturasAmostras[k], float(alturaPonte * fator));
+            }
+        }
     }
     
-    // Perpendicular (rotação 90° no sentido anti-horário)
-    vec2 perpendicular(-tangent.y, tangent.x);
+    // Aplica as alturas e refaz as normais das amostras que mudaram (e vizinhas)
+    pmr::vector<char> alterada(numPoints, 0, rascunho.recurso());
+    bool algumaAlterada = false;
+    for (int k = 0; k < numPoints; k++) {
+        float h = alturasAmostras[k];
+        if (vertices[k * 2].position.z != h || vertices[k * 2 + 1].position.z != h) {
+            vertices[k * 2].position.z = h;
+            vertices[k * 2 + 1].position.z = h;
+            alterada[k] = 1;
+            algumaAlterada = true;
+        }
+    }
     
-    return perpendicular;
+    if (normaisCalculadas && algumaAlterada) {
+        if (innerCurve.size() == size_t(numPoints)) {
+            for (int k = 0; k < numPoints; k++) {
+                if (alterada[k] || alterada[(k + 1) % numPoints] || alterada[(k - 1 + numPoints) % numPoints]) {
+                    recalcularNormaisAmostra(k);
+                }
+            }
+        } else {
+            calcularNormais();
+        }
+    }
+    
+    if (!pontesAutomaticas) alturasAmostras.clear();
 }
 
-// Calcula o ângulo entre dois vetores
-float TrackEditor::calcularAngulo(vec2 v1, vec2 v2) {
-    // Normaliza os vetores
-    float len1 = sqrt(v1.x * v1.x + v1.y * v1.y);
-    float len2 = sqrt(v2.x * v2.x + v2.y * v2.y);
+// Grava os dois vértices (interno e externo) da amostra i e os dois triângulos
+// que a ligam à próxima amostra
+void TrackEditor::escreverAmostraMalha(int i, int numPoints, vec2 innerPoint, vec2 outerPoint) {
+    Vertex& vInner = vertices[i * 2];
+    Vertex& vOuter = vertices[i * 2 + 1];
     
-    if (len1 < 0.0001f || len2 < 0.0001f) return 0.0f;
+    // Posição (Z será 0 para o editor 2D)
+    vInner.position = vec3(innerPoint.x, innerPoint.y, 0.0f);
+    vOuter.position = vec3(outerPoint.x, outerPoint.y, 0.0f);
     
-    v1 /= len1;
-    v2 /= len2;
+    // Coordenadas de textura (fixas nos cantos para cada retângulo)
+    // A textura se repete ao longo da pista
+    float v = float(i) / float(numPoints);
     
-    // Produto escalar para o cosseno do ângulo
-    float dot = v1.x * v2.x + v1.y * v2.y;
+    vInner.texCoord = vec2(0.0f, v);
+    vOuter.texCoord = vec2(1.0f, v);
     
-    // Limita o valor para evitar erros numéricos
-    dot = glm::clamp(dot, -1.0f, 1.0f);
+    // Normal será calculada depois
+    vInner.normal = vec3(0, 0, 1);
+    vOuter.normal = vec3(0, 0, 1);
     
-    return acos(dot);
+    // Triângulos conectando a amostra atual à próxima
+    int current = i * 2;
+    int next = ((i + 1) % numPoints) * 2;
+    
+    // Primeiro triângulo do retângulo
+    Triangle& t1 = triangles[current];
+    t1.v1 = current;      // Inner atual
+    t1.v2 = current + 1;  // Outer atual
+    t1.v3 = next;         // Inner próximo
+    
+    // Segundo triângulo do retângulo
+    Triangle& t2 = triangles[current + 1];
+    t2.v1 = current + 1;  // Outer atual
+    t2.v2 = next + 1;     // Outer próximo
+    t2.v3 = next;         // Inner próximo
 }
 
-// Calcula as curvas interna e externa da pista
-void TrackEditor::calcularCurvasInternaExterna(float trackWidth) {
-    innerCurve.clear();
-    outerCurve.clear();
-    
-    int numPoints = bSplinePoints.size();
-    if (numPoints < 2) {
-        cout << "Necessario gerar B-Spline antes de calcular curvas interna/externa" << endl;
-        return;
-    }
+// Grava vértices e triângulos da amostra i a partir das curvas interna/externa
+void TrackEditor::preencherVerticesAmostra(int i) {
+    escreverAmostraMalha(i, innerCurve.size(), innerCurve[i], outerCurve[i]);
     
-    // Para cada ponto da B-Spline
-    for (int i = 0; i < numPoints; i++) {
-        vec2 current = bSplinePoints[i];
-        vec2 next = bSplinePoints[(i + 1) % numPoints];
-        
-        // Calcula vetor perpendicular
-        vec2 perpendicular = calcularPerpendicular(current, next);
-        
-        // Calcula a largura da pista (metade para cada lado)
-        float halfWidth = trackWidth / 2.0f;
-        
-        // Calcula pontos interno e externo
-        vec2 innerPoint = current - perpendicular * halfWidth;
-        vec2 outerPoint = current + perpendicular * halfWidth;
-        
-        innerCurve.push_back(innerPoint);
-        outerCurve.push_back(outerPoint);
+    // Altura das pontes atuais, até concluirEdicao refazê-las
+    if (alturasAmostras.size() == innerCurve.size()) {
+        vertices[i * 2].position.z = alturasAmostras[i];
+        vertices[i * 2 + 1].position.z = alturasAmostras[i];
     }
-    
-    cout << "Curvas interna e externa calculadas com " << innerCurve.size() << " pontos cada" << endl;
 }
 
 // Triangulariza a malha da pista
 void TrackEditor::triangularizarMalha() {
+    PERFIL_ZONA("TrackEditor::triangularizarMalha");
     vertices.clear();
     triangles.clear();
+    cruzamentosPista.clear();
+    alturasAmostras.clear();
+    normaisCalculadas = false;
+    malhaEmFaixa = false;
     
     int numPoints = innerCurve.size();
     if (numPoints < 2 || outerCurve.size() != numPoints) {
@@ -189,60 +1724,46 @@ void TrackEditor::triangularizarMalha() {
         return;
     }
     
-    // Cria vértices da malha
-    for (int i = 0; i < numPoints; i++) {
-        Vertex vInner, vOuter;
-        
-        // Posição (Z será 0 para o editor 2D)
-        vInner.position = vec3(innerCurve[i].x, innerCurve[i].y, 0.0f);
-        vOuter.position = vec3(outerCurve[i].x, outerCurve[i].y, 0.0f);
-        
-        // Coordenadas de textura (fixas nos cantos para cada retângulo)
-        // A textura se repete ao longo da pista
-        float v = float(i) / float(numPoints);
-        
-        vInner.texCoord = vec2(0.0f, v);
-        vOuter.texCoord = vec2(1.0f, v);
-        
-        // Normal será calculada depois
-        vInner.normal = vec3(0, 0, 1);
-        vOuter.normal = vec3(0, 0, 1);
-        
-        vertices.push_back(vInner);
-        vertices.push_back(vOuter);
-    }
+    // Cria vértices e triângulos já dimensionados; cada amostra
+    // grava os seus 2 vértices e os 2 triângulos até a próxima
+    redimensionarSaida(vertices, size_t(numPoints) * 2);
+    redimensionarSaida(triangles, size_t(numPoints) * 2);
     
-    // Cria triângulos conectando os vértices
-    for (int i = 0; i < numPoints; i++) {
-        int current = i * 2;
-        int next = ((i + 1) % numPoints) * 2;
-        
-        // Primeiro triângulo do retângulo
-        Triangle t1;
-        t1.v1 = current;      // Inner atual
-        t1.v2 = current + 1;  // Outer atual
-        t1.v3 = next;         // Inner próximo
-        triangles.push_back(t1);
-        
-        // Segundo triângulo do retângulo
-        Triangle t2;
-        t2.v1 = current + 1;  // Outer atual
-        t2.v2 = next + 1;     // Outer próximo
-        t2.v3 = next;         // Inner próximo
-        triangles.push_back(t2);
-    }
+    ThreadPool::global().paraCada(numPoints, AMOSTRAS_POR_BLOCO, [&](int inicio, int fim) {
+        for (int i = inicio; i < fim; i++) {
+            preencherVerticesAmostra(i);
+        }
+    });
+    malhaEmFaixa = true;
     
     cout << "Malha triangularizada com " << vertices.size() << " vertices e " 
          << triangles.size() << " triangulos" << endl;
+    
+    if (pontesAutomaticas) aplicarPontes();
 }
 
 // Calcula as normais das faces
 void TrackEditor::calcularNormais() {
+    PERFIL_ZONA("TrackEditor::calcularNormais");
     if (vertices.empty() || triangles.empty()) {
         cout << "Necessario triangularizar antes de calcular normais" << endl;
         return;
     }
     
+    // Malha em faixa (gerada por triangularizarMalha): cada amostra soma só os triângulos
+    // vizinhos, então as amostras são independentes e calculadas em paralelo
+    if (malhaEmFaixa && vertices.size() == innerCurve.size() * 2 && triangles.size() == vertices.size()) {
+        ThreadPool::global().paraCada(innerCurve.size(), AMOSTRAS_POR_BLOCO, [&](int inicio, int fim) {
+            for (int i = inicio; i < fim; i++) {
+                recalcularNormaisAmostra(i);
+            }
+        });
+        
+        normaisCalculadas = true;
+        cout << "Normais calculadas" << endl;
+        return;
+    }
+    
     // Inicializa todas as normais como zero
     for (auto& v : vertices) {
         v.normal = vec3(0, 0, 0);
@@ -277,11 +1798,31 @@ void TrackEditor::calcularNormais() {
         }
     }
     
+    normaisCalculadas = true;
     cout << "Normais calculadas" << endl;
 }
 
+// Copia os dados das exportações; assign reaproveita a capacidade do instantâneo anterior
+void TrackEditor::capturarInstantaneo(InstantaneoPista& destino, float espacamentoCurva) {
+    PERFIL_ZONA("TrackEditor::capturarInstantaneo");
+    destino.vertices.assign(vertices.begin(), vertices.end());
+    destino.triangles.assign(triangles.begin(), triangles.end());
+    destino.pontosCurva.assign(bSplinePoints.begin(), bSplinePoints.end());
+    destino.alturasAmostras.assign(alturasAmostras.begin(), alturasAmostras.end());
+    
+    // A tabela de comprimento só é usada pela curva com espaçamento
+    if (espacamentoCurva > 0.0f && !bSplinePoints.empty()) {
+        if (!tabelaComprimentoValida) calcularTabelaComprimento();
+        destino.comprimentoAcumulado.assign(comprimentoAcumulado.begin(), comprimentoAcumulado.end());
+    } else {
+        destino.comprimentoAcumulado.clear();
+    }
+}
+
 // Exporta a pista para arquivo OBJ
-bool TrackEditor::exportarOBJ(const string& outputPath) {
+bool TrackEditor::exportarOBJ(const vector<Vertex>& vertices, const vector<Triangle>& triangles,
+                              const string& outputPath) {
+    PERFIL_ZONA("TrackEditor::exportarOBJ");
     if (vertices.empty() || triangles.empty()) {
         cout << "Nenhuma malha para exportar" << endl;
         return false; }
@@ -295,40 +1836,79 @@ bool TrackEditor::exportarOBJ(const string& outputPath) {
         cout << "Erro ao abrir arquivo: " << filenameObj << endl;
         return false; }
     
-    file << "# Editor de Pista de Corrida" << endl;
-    file << "# Quantidade de Vertices: " << vertices.size() << endl;
-    file << "# Quantidade de Faces/Triangulos: " << triangles.size() << endl;
-    file << endl;
-    
-    file << "mtllib " << filenameMtl << endl;
-    file << "usemtl track_material" << endl;
-    file << endl;
-    
-    // Exporta vértices (converte Y -> Z para o visualizador 3D)
-    for (const auto& v : vertices) {
-        file << "v " << v.position.x << " " << v.position.z << " " << v.position.y << endl;
-    }
-
-    file << endl;
-    
-    // Exporta coordenadas de textura
-    for (const auto& v : vertices) {
-        file << "vt " << v.texCoord.x << " " << v.texCoord.y << endl;
-    }
-    file << endl;
-    
-    // Exporta normais (converte Y -> Z para o visualizador 3D)
-    for (const auto& v : vertices) {
-        file << "vn " << v.normal.x << " " << v.normal.z << " " << v.normal.y << endl;
-    }
-    file << endl;
-    
-    // Exporta faces (OBJ usa índices começando em 1)
-    for (const auto& tri : triangles) {
-        file << "f " 
-             << (tri.v1 + 1) << "/" << (tri.v1 + 1) << "/" << (tri.v1 + 1) << " "
-             << (tri.v2 + 1) << "/" << (tri.v2 + 1) << "/" << (tri.v2 + 1) << " "
-             << (tri.v3 + 1) << "/" << (tri.v3 + 1) << "/" << (tri.v3 + 1) << endl;
+    // Texto montado em blocos grandes (ver EscritorTexto); mesmo conteúdo, byte a byte,
+    // da escrita linha a linha com operator<< e endl. As seções v/vt/vn/f são formatadas
+    // em paralelo, em blocos de linhas gravados na ordem (escreverLinhasEmParalelo).
+    {
+        EscritorTexto saida(file);
+        
+        // Dois blocos por thread em cada onda, para equilibrar a carga
+        vector<EscritorTexto> blocos;
+        int numBlocos = ThreadPool::global().obterNumeroDeThreads() * 2;
+        blocos.reserve(numBlocos);
+        for (int b = 0; b < numBlocos; b++) blocos.emplace_back(size_t(LINHAS_POR_BLOCO_EXPORTACAO) * 48);
+        
+        saida.texto("# Editor de Pista de Corrida\n# Quantidade de Vertices: ");
+        saida.inteiro(vertices.size());
+        saida.texto("\n# Quantidade de Faces/Triangulos: ");
+        saida.inteiro(triangles.size());
+        saida.texto("\n\nmtllib ");
+        saida.texto(filenameMtl);
+        saida.texto("\nusemtl track_material\n\n");
+        
+        int numVertices = vertices.size();
+        
+        // Exporta vértices (converte Y -> Z para o visualizador 3D)
+        escreverLinhasEmParalelo(saida, blocos, numVertices, [&](EscritorTexto& bloco, int i) {
+            const Vertex& v = vertices[i];
+            bloco.texto("v ", 2);
+            bloco.real(v.position.x);
+            bloco.caractere(' ');
+            bloco.real(v.position.z);
+            bloco.caractere(' ');
+            bloco.real(v.position.y);
+            bloco.caractere('\n');
+        });
+        saida.caractere('\n');
+        
+        // Exporta coordenadas de textura
+        escreverLinhasEmParalelo(saida, blocos, numVertices, [&](EscritorTexto& bloco, int i) {
+            const Vertex& v = vertices[i];
+            bloco.texto("vt ", 3);
+            bloco.real(v.texCoord.x);
+            bloco.caractere(' ');
+            bloco.real(v.texCoord.y);
+            bloco.caractere('\n');
+        });
+        saida.caractere('\n');
+        
+        // Exporta normais (converte Y -> Z para o visualizador 3D)
+        escreverLinhasEmParalelo(saida, blocos, numVertices, [&](EscritorTexto& bloco, int i) {
+            const Vertex& v = vertices[i];
+            bloco.texto("vn ", 3);
+            bloco.real(v.normal.x);
+            bloco.caractere(' ');
+            bloco.real(v.normal.z);
+            bloco.caractere(' ');
+            bloco.real(v.normal.y);
+            bloco.caractere('\n');
+        });
+        saida.caractere('\n');
+        
+        // Exporta faces (OBJ usa índices começando em 1; v/vt/vn com o mesmo índice)
+        escreverLinhasEmParalelo(saida, blocos, triangles.size(), [&](EscritorTexto& bloco, int t) {
+            const Triangle& tri = triangles[t];
+            bloco.caractere('f');
+            for (int indice : { tri.v1 + 1, tri.v2 + 1, tri.v3 + 1 }) {
+                bloco.caractere(' ');
+                bloco.inteiro(indice);
+                bloco.caractere('/');
+                bloco.inteiro(indice);
+                bloco.caractere('/');
+                bloco.inteiro(indice);
+            }
+            bloco.caractere('\n');
+        });
     }
     
     file.close();
@@ -343,7 +1923,7 @@ bool TrackEditor::exportarOBJ(const string& outputPath) {
         mtlFile << "Kd 0.8 0.8 0.8" << endl;
         mtlFile << "Ks 0.3 0.3 0.3" << endl;
         mtlFile << "Ns 32" << endl;
-        mtlFile << "map_Kd textures/asfalto.jpg" << endl;
+        mtlFile << "map_Kd " << TEXTURA_PISTA << endl;
         mtlFile.close();
         cout << "Material exportado para: " << filenameMtl << endl;
     }
@@ -351,13 +1931,359 @@ bool TrackEditor::exportarOBJ(const string& outputPath) {
     return true;
 }
 
+// Triângulos por bloco na tabela de blocos do .trk
+const int TRIANGULOS_POR_BLOCO_TRK = 8192;
+
+// Vértice no sistema do visualizador 3D e dos formatos binários (Y <-> Z, como no OBJ)
+static Vertex paraVisualizador(const Vertex& v) {
+    Vertex c;
+    c.position = vec3(v.position.x, v.position.z, v.position.y);
+    c.normal = vec3(v.normal.x, v.normal.z, v.normal.y);
+    c.texCoord = v.texCoord;
+    return c;
+}
+
+// Caixa envolvente das posições convertidas para o visualizador
+static void caixaVisualizador(const vector<Vertex>& vertices, vec3& minimo, vec3& maximo) {
+    minimo = maximo = paraVisualizador(vertices[0]).position;
+    for (const auto& v : vertices) {
+        vec3 p = paraVisualizador(v).position;
+        minimo = glm::min(minimo, p);
+        maximo = glm::max(maximo, p);
+    }
+}
+
+// Grava os vértices convertidos para o visualizador, em lotes (sem cópia da malha inteira)
+static void gravarVerticesVisualizador(ofstream& file, const vector<Vertex>& vertices) {
+    const size_t VERTICES_POR_LOTE = 1024;
+    Vertex lote[VERTICES_POR_LOTE];
+    for (size_t inicio = 0; inicio < vertices.size(); inicio += VERTICES_POR_LOTE) {
+        size_t quantidade = std::min(vertices.size() - inicio, VERTICES_POR_LOTE);
+        for (size_t i = 0; i < quantidade; i++) lote[i] = paraVisualizador(vertices[inicio + i]);
+        file.write(reinterpret_cast<const char*>(lote), quantidade * sizeof(Vertex));
+    }
+}
+
+// Exporta a malha no formato binário .trk (ver MalhaTRK.h), que o visualizador mapeia na
+// memória e usa sem parsing. Os vértices são convertidos para o sistema do visualizador
+// (Y <-> Z, como no OBJ) em lotes; os triângulos já têm o layout de 3 índices de 32 bits
+// e são gravados direto do vetor.
+bool TrackEditor::exportarTRK(const vector<Vertex>& vertices, const vector<Triangle>& triangles,
+                              const string& outputPath) {
+    PERFIL_ZONA("TrackEditor::exportarTRK");
+    static_assert(sizeof(Triangle) == 3 * sizeof(uint32_t), "Triangle deve ser 3 indices de 32 bits");
+    
+    if (vertices.empty() || triangles.empty()) {
+        cout << "Nenhuma malha para exportar" << endl;
+        return false; }
+    
+    string filenameTrk = outputPath + "track.trk";
+    
+    ofstream file(filenameTrk, ios::binary); // stream para o arquivo .trk
+    
+    if (!file.is_open()) {
+        cout << "Erro ao abrir arquivo: " << filenameTrk << endl;
+        return false; }
+    
+    // Tabela de blocos: faixas de triângulos consecutivos (trechos da pista) e suas caixas
+    int numTriangulos = triangles.size();
+    int numBlocos = (numTriangulos + TRIANGULOS_POR_BLOCO_TRK - 1) / TRIANGULOS_POR_BLOCO_TRK;
+    vector<BlocoTRK> blocos(numBlocos);
+    ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+        for (int b = primeiro; b < ultimo; b++) {
+            int inicio = b * TRIANGULOS_POR_BLOCO_TRK;
+            int fim = std::min(numTriangulos, inicio + TRIANGULOS_POR_BLOCO_TRK);
+            
+            vec3 minimo = paraVisualizador(vertices[triangles[inicio].v1]).position, maximo = minimo;
+            for (int t = inicio; t < fim; t++) {
+                for (int idx : { triangles[t].v1, triangles[t].v2, triangles[t].v3 }) {
+                    vec3 p = paraVisualizador(vertices[idx]).position;
+                    minimo = glm::min(minimo, p);
+                    maximo = glm::max(maximo, p);
+                }
+            }
+            blocos[b] = { uint32_t(inicio * 3), uint32_t((fim - inicio) * 3),
+                          { minimo.x, minimo.y, minimo.z }, { maximo.x, maximo.y, maximo.z } };
+        }
+    });
+    
+    auto alinhar = [](uint64_t deslocamento) {
+        return (deslocamento + ALINHAMENTO_TRK - 1) / ALINHAMENTO_TRK * ALINHAMENTO_TRK;
+    };
+    
+    CabecalhoTRK cabecalho = {};
+    memcpy(cabecalho.magia, MAGIA_TRK, sizeof(MAGIA_TRK));
+    cabecalho.versao = VERSAO_TRK;
+    cabecalho.tamanhoCabecalho = sizeof(CabecalhoTRK);
+    cabecalho.tamanhoVertice = sizeof(Vertex);
+    cabecalho.numVertices = vertices.size();
+    cabecalho.numIndices = uint64_t(numTriangulos) * 3;
+    cabecalho.numBlocos = numBlocos;
+    cabecalho.deslocamentoVertices = alinhar(sizeof(CabecalhoTRK));
+    cabecalho.deslocamentoIndices = alinhar(cabecalho.deslocamentoVertices + cabecalho.numVertices * sizeof(Vertex));
+    cabecalho.deslocamentoBlocos = alinhar(cabecalho.deslocamentoIndices + cabecalho.numIndices * sizeof(uint32_t));
+    
+    vec3 minimo, maximo;
+    caixaVisualizador(vertices, minimo, maximo);
+    for (int k = 0; k < 3; k++) {
+        cabecalho.minimo[k] = minimo[k];
+        cabecalho.maximo[k] = maximo[k];
+    }
+    
+    // Escrita sequencial; completarAte preenche com zeros até o início da próxima seção
+    uint64_t escrito = 0;
+    auto gravar = [&](const void* dados, uint64_t bytes) {
+        file.write(static_cast<const char*>(dados), bytes);
+        escrito += bytes;
+    };
+    auto completarAte = [&](uint64_t deslocamento) {
+        static const char zeros[ALINHAMENTO_TRK] = {};
+        gravar(zeros, deslocamento - escrito);
+    };
+    
+    gravar(&cabecalho, sizeof(cabecalho));
+    
+    completarAte(cabecalho.deslocamentoVertices);
+    gravarVerticesVisualizador(file, vertices);
+    escrito += cabecalho.numVertices * sizeof(Vertex);
+    
+    completarAte(cabecalho.deslocamentoIndices);
+    gravar(triangles.data(), cabecalho.numIndices * sizeof(uint32_t));
+    
+    completarAte(cabecalho.deslocamentoBlocos);
+    gravar(blocos.data(), blocos.size() * sizeof(BlocoTRK));
+    
+    if (!file) {
+        cout << "Erro ao gravar arquivo: " << filenameTrk << endl;
+        return false;
+    }
+    file.close();
+    cout << "Malha binaria exportada para: " << filenameTrk << " (" << vertices.size()
+         << " vertices, " << numTriangulos << " triangulos)" << endl;
+    return true;
+}
+
+// Exporta a pista como glTF 2.0 binário (GLB): cabeçalho + bloco JSON + bloco BIN.
+// O BIN tem os vértices intercalados (posição, normal, UV; mesmo Vertex do .trk, com
+// Y <-> Z) seguidos dos índices uint32; o JSON é escrito direto como texto, sem montar
+// uma árvore, e descreve uma bufferView para cada parte e um accessor por atributo.
+// O material repete o de track.mtl em PBR (Kd -> cor base, Ns -> rugosidade) e é de
+// dupla face, porque a orientação dos triângulos depende do sentido em que a pista foi
+// desenhada.
+bool TrackEditor::exportarGLB(const vector<Vertex>& vertices, const vector<Triangle>& triangles,
+                              const string& outputPath) {
+    PERFIL_ZONA("TrackEditor::exportarGLB");
+    if (vertices.empty() || triangles.empty()) {
+        cout << "Nenhuma malha para exportar" << endl;
+        return false; }
+    
+    string filenameGlb = outputPath + "track.glb";
+    
+    uint64_t bytesVertices = uint64_t(vertices.size()) * sizeof(Vertex);
+    uint64_t numIndices = uint64_t(triangles.size()) * 3;
+    uint64_t bytesBin = bytesVertices + numIndices * sizeof(uint32_t);   // Já múltiplo de 4
+    
+    // GLB usa tamanhos de 32 bits
+    if (bytesBin > 0xFFFF0000ull) {
+        cout << "Malha grande demais para GLB (" << bytesBin << " bytes)" << endl;
+        return false; }
+    
+    ofstream file(filenameGlb, ios::binary); // stream para o arquivo GLB
+    
+    if (!file.is_open()) {
+        cout << "Erro ao abrir arquivo: " << filenameGlb << endl;
+        return false; }
+    
+    vec3 minimo, maximo;
+    caixaVisualizador(vertices, minimo, maximo);
+    
+    // Rugosidade equivalente ao expoente especular do MTL (Ns 32)
+    float rugosidade = sqrt(2.0f / (32.0f + 2.0f));
+    
+    EscritorTexto json(4096);
+    json.texto("{\"asset\":{\"version\":\"2.0\",\"generator\":\"Editor de Pista de Corrida\"},"
+               "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+               "\"nodes\":[{\"name\":\"pista\",\"mesh\":0}],"
+               "\"meshes\":[{\"name\":\"pista\",\"primitives\":[{"
+               "\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},"
+               "\"indices\":3,\"material\":0,\"mode\":4}]}],");
+    
+    json.texto("\"materials\":[{\"name\":\"track_material\",\"doubleSided\":true,"
+               "\"pbrMetallicRoughness\":{\"baseColorFactor\":[0.8,0.8,0.8,1],"
+               "\"baseColorTexture\":{\"index\":0},\"metallicFactor\":0,\"roughnessFactor\":");
+    json.realExato(rugosidade);
+    json.texto("}}],\"textures\":[{\"sampler\":0,\"source\":0}],"
+               "\"samplers\":[{\"wrapS\":10497,\"wrapT\":10497}],"
+               "\"images\":[{\"uri\":\"");
+    json.texto(TEXTURA_PISTA);
+    json.texto("\"}],");
+    
+    // Buffer único (o bloco BIN) com duas views: vértices intercalados e índices
+    json.texto("\"buffers\":[{\"byteLength\":");
+    json.inteiro(bytesBin);
+    json.texto("}],\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":");
+    json.inteiro(bytesVertices);
+    json.texto(",\"byteStride\":");
+    json.inteiro(sizeof(Vertex));
+    json.texto(",\"target\":34962},{\"buffer\":0,\"byteOffset\":");
+    json.inteiro(bytesVertices);
+    json.texto(",\"byteLength\":");
+    json.inteiro(numIndices * sizeof(uint32_t));
+    json.texto(",\"target\":34963}],");
+    
+    // Accessors: POSITION (com limites, obrigatórios), NORMAL, TEXCOORD_0 e índices
+    json.texto("\"accessors\":[{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":");
+    json.inteiro(vertices.size());
+    json.texto(",\"type\":\"VEC3\",\"min\":[");
+    for (int k = 0; k < 3; k++) {
+        if (k > 0) json.caractere(',');
+        json.realExato(minimo[k]);
+    }
+    json.texto("],\"max\":[");
+    for (int k = 0; k < 3; k++) {
+        if (k > 0) json.caractere(',');
+        json.realExato(maximo[k]);
+    }
+    json.texto("]},{\"bufferView\":0,\"byteOffset\":");
+    json.inteiro(offsetof(Vertex, normal));
+    json.texto(",\"componentType\":5126,\"count\":");
+    json.inteiro(vertices.size());
+    json.texto(",\"type\":\"VEC3\"},{\"bufferView\":0,\"byteOffset\":");
+    json.inteiro(offsetof(Vertex, texCoord));
+    json.texto(",\"componentType\":5126,\"count\":");
+    json.inteiro(vertices.size());
+    json.texto(",\"type\":\"VEC2\"},{\"bufferView\":1,\"byteOffset\":0,\"componentType\":5125,\"count\":");
+    json.inteiro(numIndices);
+    json.texto(",\"type\":\"SCALAR\"}]}");
+    
+    // O bloco JSON é completado com espaços até múltiplo de 4
+    while (json.tamanho() % 4 != 0) json.caractere(' ');
+    
+    uint32_t cabecalho[3] = { 0x46546C67u, 2, uint32_t(12 + 8 + json.tamanho() + 8 + bytesBin) };  // "glTF"
+    uint32_t blocoJson[2] = { uint32_t(json.tamanho()), 0x4E4F534Au };                              // "JSON"
+    uint32_t blocoBin[2] = { uint32_t(bytesBin), 0x004E4942u };                                     // "BIN\0"
+    
+    file.write(reinterpret_cast<const char*>(cabecalho), sizeof(cabecalho));
+    file.write(reinterpret_cast<const char*>(blocoJson), sizeof(blocoJson));
+    file.write(json.dados(), json.tamanho());
+    file.write(reinterpret_cast<const char*>(blocoBin), sizeof(blocoBin));
+    gravarVerticesVisualizador(file, vertices);
+    file.write(reinterpret_cast<const char*>(triangles.data()), numIndices * sizeof(uint32_t));
+    
+    if (!file) {
+        cout << "Erro ao gravar arquivo: " << filenameGlb << endl;
+        return false;
+    }
+    file.close();
+    cout << "Pista exportada para: " << filenameGlb << endl;
+    return true;
+}
+
+// Monta a tabela de comprimento de arco acumulado da curva fechada (N + 1 valores).
+// Em curvas grandes a soma de prefixos é feita em paralelo: cada bloco soma seus trechos,
+// os totais dos blocos são acumulados e cada bloco soma o deslocamento do anterior.
+// Os blocos têm tamanho fixo, então o resultado não depende da quantidade de threads.
+void TrackEditor::calcularTabelaComprimento() {
+    PERFIL_ZONA("TrackEditor::calcularTabelaComprimento");
+    int numPoints = bSplinePoints.size();
+    reservarComFolga(comprimentoAcumulado, numPoints + 1);
+    comprimentoAcumulado.assign(numPoints + 1, 0.0);
+    tabelaComprimentoValida = true;
+    if (numPoints < 2) return;
+    
+    const int tamanhoBloco = 1 << 16;
+    int numBlocos = (numPoints + tamanhoBloco - 1) / tamanhoBloco;
+    
+    // Passo 1: soma de prefixos local de cada bloco (comprimentoAcumulado[i + 1] = fim do trecho i)
+    auto somarBloco = [&](int bloco) {
+        int inicio = bloco * tamanhoBloco;
+        int fim = std::min(inicio + tamanhoBloco, numPoints);
+        double soma = 0.0;
+        for (int i = inicio; i < fim; i++) {
+            soma += length(bSplinePoints[(i + 1) % numPoints] - bSplinePoints[i]);
+            comprimentoAcumulado[i + 1] = soma;
+        }
+    };
+    
+    // Passo 3: soma o total dos blocos anteriores
+    EscopoRascunho escopo(*this);
+    pmr::vector<double> deslocamento(numBlocos, 0.0, rascunho.recurso());
+    auto deslocarBloco = [&](int bloco) {
+        int inicio = bloco * tamanhoBloco;
+        int fim = std::min(inicio + tamanhoBloco, numPoints);
+        for (int i = inicio; i < fim; i++) {
+            comprimentoAcumulado[i + 1] += deslocamento[bloco];
+        }
+    };
+    
+    auto executarEmParalelo = [&](auto&& tarefa) {
+        ThreadPool::global().paraCada(numBlocos, 1, [&](int primeiro, int ultimo) {
+            for (int b = primeiro; b < ultimo; b++) tarefa(b);
+        });
+    };
+    
+    executarEmParalelo(somarBloco);
+    
+    // Passo 2: soma de prefixos (serial) dos totais dos blocos
+    for (int b = 1; b < numBlocos; b++) {
+        int fimAnterior = std::min(b * tamanhoBloco, numPoints);
+        deslocamento[b] = deslocamento[b - 1] + comprimentoAcumulado[fimAnterior];
+    }
+    
+    executarEmParalelo(deslocarBloco);
+}
+
+// Posição na curva a uma distância (comprimento de arco) a partir da primeira amostra.
+// Busca binária na tabela: O(log n). Distâncias fora de [0, total) dão a volta na pista.
+vec2 TrackEditor::posicaoNaDistancia(float distancia) {
+    if (!tabelaComprimentoValida) calcularTabelaComprimento();
+    
+    int numPoints = bSplinePoints.size();
+    if (numPoints == 0) return vec2(0, 0);
+    double total = comprimentoAcumulado[numPoints];
+    if (total <= 0.0) return bSplinePoints[0];
+    
+    double s = fmod(double(distancia), total);
+    if (s < 0.0) s += total;
+    
+    // Primeiro valor acumulado > s: a distância cai no trecho anterior
+    auto it = upper_bound(comprimentoAcumulado.begin() + 1, comprimentoAcumulado.end(), s);
+    int i = std::min(int(it - comprimentoAcumulado.begin()) - 1, numPoints - 1);
+    
+    double trecho = comprimentoAcumulado[i + 1] - comprimentoAcumulado[i];
+    float f = trecho > 0.0 ? float((s - comprimentoAcumulado[i]) / trecho) : 0.0f;
+    return mix(bSplinePoints[i], bSplinePoints[(i + 1) % numPoints], f);
+}
+
+// Comprimento total da curva fechada
+float TrackEditor::obterComprimentoTotal() {
+    if (!tabelaComprimentoValida) calcularTabelaComprimento();
+    return bSplinePoints.empty() ? 0.0f : float(comprimentoAcumulado.back());
+}
+
 // Exporta a curva b-spline para arquivo de animação
-bool TrackEditor::exportarCurvaAnimacao(const string& outputPath) {
+bool TrackEditor::exportarCurvaAnimacao(const string& outputPath, float espacamento) {
+    if (espacamento > 0.0f && !bSplinePoints.empty() && !tabelaComprimentoValida) calcularTabelaComprimento();
+    return exportarCurvaAnimacao(bSplinePoints, alturasAmostras, comprimentoAcumulado, outputPath, espacamento);
+}
+
+bool TrackEditor::exportarCurvaAnimacao(const vector<vec2>& bSplinePoints, const vector<float>& alturasAmostras,
+                                        const vector<double>& comprimentoAcumulado,
+                                        const string& outputPath, float espacamento) {
+    PERFIL_ZONA("TrackEditor::exportarCurvaAnimacao");
 
     if (bSplinePoints.empty()) {
         cout << "Nenhuma curva para exportar" << endl;
         return false; }
     
+    // Validado antes de abrir o arquivo: em erro, a exportação anterior fica intacta
+    int numPoints = bSplinePoints.size();
+    bool espacada = espacamento > 0.0f;
+    if (espacada && comprimentoAcumulado.size() != size_t(numPoints) + 1) {
+        cout << "Tabela de comprimento da curva ausente; exportacao da curva cancelada" << endl;
+        return false;
+    }
+    
     string filenameTxt = outputPath + "track_curve.txt";    
 
     ofstream file(filenameTxt); // stream para o arquivo de curva
@@ -366,16 +2292,126 @@ bool TrackEditor::exportarCurvaAnimacao(const string& outputPath) {
         cout << "Erro ao abrir arquivo: " << filenameTxt << endl;
         return false; }
     
-    file << "# Curva de Animacao b-Spline" << endl;
-    file << "# Total de pontos: " << bSplinePoints.size() << endl;
-    file << endl;
+    // Alturas das pontes, quando a malha atual corresponde às amostras da curva
+    bool comAlturas = alturasAmostras.size() == bSplinePoints.size();
+    
+    // Uma linha "x y z" por ponto, no mesmo formato de operator<<
+    EscritorTexto saida(file);
+    auto escreverPonto = [&saida](vec2 point, float altura) {
+        saida.real(point.x);
+        saida.caractere(' ');
+        saida.real(altura);
+        saida.caractere(' ');
+        saida.real(point.y);
+        saida.caractere('\n');
+    };
     
-    // Exporta pontos da curva B-Spline (Y -> Z para o visualizador)
-    for (const auto& point : bSplinePoints) { file << point.x << " " << 0.0f << " " << point.y << endl; }
+    // Sem espaçamento: exporta as amostras da B-Spline (uniformes no parâmetro, não na distância)
+    if (!espacada) {
+        saida.texto("# Curva de Animacao b-Spline\n# Total de pontos: ");
+        saida.inteiro(bSplinePoints.size());
+        saida.texto("\n\n");
+        
+        // Exporta pontos da curva B-Spline (Y -> Z para o visualizador; altura das pontes em Y)
+        for (int i = 0; i < numPoints; i++) {
+            escreverPonto(bSplinePoints[i], comAlturas ? alturasAmostras[i] : 0.0f);
+        }
+    }
+    // Com espaçamento: amostras igualmente espaçadas ao longo do comprimento de arco
+    else {
+        double total = comprimentoAcumulado[numPoints];
+        int quantidade = std::max(1, int(total / espacamento));
+        
+        saida.texto("# Curva de Animacao b-Spline (amostras igualmente espacadas)\n# Total de pontos: ");
+        saida.inteiro(quantidade);
+        saida.texto("\n# Espacamento: ");
+        saida.real(total / quantidade);
+        saida.texto("\n\n");
+        
+        // Distâncias crescentes: avança o trecho sequencialmente em vez de buscar cada uma
+        int i = 0;
+        for (int k = 0; k < quantidade; k++) {
+            double s = total * k / quantidade;
+            while (i < numPoints - 1 && comprimentoAcumulado[i + 1] <= s) i++;
+            
+            double trecho = comprimentoAcumulado[i + 1] - comprimentoAcumulado[i];
+            float f = trecho > 0.0 ? float((s - comprimentoAcumulado[i]) / trecho) : 0.0f;
+            vec2 point = mix(bSplinePoints[i], bSplinePoints[(i + 1) % numPoints], f);
+            float altura = comAlturas ? mix(alturasAmostras[i], alturasAmostras[(i + 1) % numPoints], f) : 0.0f;
+            
+            escreverPonto(point, altura);
+        }
+    }
     
+    saida.descarregar();
     file.close();
 
     cout << "Curva de animacao exportada para: " << filenameTxt << endl;
     
     return true;
 }
+
+// Importa a curva de animação como a curva da pista. Sem pontos de controle, a edição
+// incremental não altera a curva importada; gerar uma nova curva (G/F) a substitui.
+bool TrackEditor::importarCurvaAnimacao(const string& filename) {
+    PERFIL_ZONA("TrackEditor::importarCurvaAnimacao");
+    if (!lerCurvaAnimacao(filename, bSplinePoints, alturasAmostras)) return false;
+    
+    pontosDeControle.clear();
+    geracaoPontos++;
+    marcarCurvasAlteradas();
+    descartarTrechosAlterados();
+    inicioSegmento.clear();
+    tabelaComprimentoValida = false;
+    innerCurve.clear();
+    outerCurve.clear();
+    vertices.clear();
+    triangles.clear();
+    trechosCorrigidos.clear();
+    cruzamentosPista.clear();
+    normaisCalculadas = false;
+    malhaEmFaixa = false;
+    
+    // Alturas todas zero: curva sem pontes
+    if (all_of(alturasAmostras.begin(), alturasAmostras.end(), [](float h) { return h == 0.0f; })) {
+        alturasAmostras.clear();
+    }
+    
+    // Tangente de cada amostra por diferença central na curva fechada, em relação a um
+    // parâmetro de 0 a 1 na curva inteira (as bordas só usam a direção). O arquivo guarda
+    // 6 algarismos significativos: em curvas muito densas o arredondamento é da ordem do
+    // espaçamento entre amostras, então a diferença usa vizinhos mais distantes até a
+    // corda ficar bem maior que esse erro (senão as bordas saem serrilhadas).
+    int numPoints = bSplinePoints.size();
+    float escala = 0.0f;
+    for (const vec2& p : bSplinePoints) escala = std::max(escala, std::max(fabs(p.x), fabs(p.y)));
+    float cordaMinima = escala * 1e-3f;
+    
+    redimensionarSaida(bSplineDerivadas, numPoints);
+    ThreadPool::global().paraCada(numPoints, AMOSTRAS_POR_BLOCO, [&](int inicio, int fim) {
+        for (int i = inicio; i < fim; i++) {
+            int k = 1;
+            vec2 diferenca = bSplinePoints[(i + 1) % numPoints] - bSplinePoints[(i - 1 + numPoints) % numPoints];
+            while (length(diferenca) < cordaMinima && k < numPoints / 8) {
+                k++;
+                diferenca = bSplinePoints[(i + k) % numPoints] - bSplinePoints[((i - k) % numPoints + numPoints) % numPoints];
+            }
+            bSplineDerivadas[i] = diferenca * (numPoints * 0.5f / k);
+        }
+    });
+    return true;
+}
+
+// Importa a malha de um OBJ. Ela não segue o layout em faixa das amostras, então as pontes
+// e a edição incremental não a alteram; sem normais no arquivo, elas são calculadas.
+bool TrackEditor::importarOBJ(const string& filename) {
+    PERFIL_ZONA("TrackEditor::importarOBJ");
+    bool comNormais = false;
+    if (!lerOBJ(filename, vertices, triangles, &comNormais)) return false;
+    
+    cruzamentosPista.clear();
+    malhaEmFaixa = false;
+    normaisCalculadas = comNormais;
+    if (!comNormais) calcularNormais();
+    return true;
+}